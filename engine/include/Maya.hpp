@@ -13,6 +13,8 @@
 #include "./Maya/vertex_array.hpp"
 #include "./Maya/shader.hpp"
 #include "./Maya/texture.hpp"
+#include "./Maya/texture_atlas.hpp"
+#include "./Maya/render_target.hpp"
 #include "./Maya/font.hpp"
 #include "./Maya/audio_stream.hpp"
 #include "./Maya/resources.hpp"
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "./graphics.hpp"
+
+namespace Maya {
+
+// Records the draws made by a Graphics2D once and keeps them inside a vertex buffer,
+// so static content is replayed every frame with one draw call per texture.
+//
+//	if (!list.IsValid()) {
+//		list.Begin(g);
+//		g.DrawRect(...); g.DrawText(...);
+//		list.End();
+//	}
+//	list.Draw(g, Translate(offset), tint);
+//
+// Only draws going through the vertex stream are recorded, SpriteBatch draws are not.
+class CommandList2D
+{
+public:
+	CommandList2D();
+	~CommandList2D();
+
+	// Capture every following draw of the Graphics2D instead of drawing it, discards the previous recording
+	void Begin(Graphics2D& g);
+
+	// Stop capturing and upload the recorded vertices
+	void End();
+
+	// Mark the recording as outdated, IsValid returns false until it is recorded again
+	void Invalidate();
+	bool IsValid() const;
+
+	// Replay the recording with the camera and projection of a Graphics2D
+	// @param transform: applied to every recorded position
+	// @param tint: multiplied with every recorded color, and with the texels of texture only fills
+	void Draw(Graphics2D& g, Fmat4 const& transform = Fmat4(1.0f), Fvec4 const& tint = Fvec4(1.0f));
+
+private:
+	// Vertices sharing a texture, drawn with a single call
+	struct Segment { Texture* texture; int first, count; };
+
+	std::vector<float> vertices;
+	std::vector<Segment> segments;
+	VertexArray* vao;
+	int capacity;
+	Graphics2D* recorder;
+	bool valid;
+	Fvec4 bounds; // (min x, min y, max x, max y) of the recorded positions
+	std::uint64_t hash; // of the recorded vertices, for RedrawMode::Damaged
+
+	float* Allocate(int count, Texture* texture);
+	friend class Graphics2D;
+
+	CommandList2D(CommandList2D const&) = delete;
+	CommandList2D& operator=(CommandList2D const&) = delete;
+};
+
+}
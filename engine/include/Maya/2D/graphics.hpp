@@ -3,9 +3,13 @@
 #include "../math.hpp"
 #include "../shader.hpp"
 #include "../font.hpp"
+#include "../texture_atlas.hpp"
 
 namespace Maya {
 
+class CommandList2D;
+class Path2D;
+
 class Graphics2D
 {
 public:
@@ -26,12 +30,72 @@ public:
 		GlowCenterExclusive
 	};
 
+	// How consecutive segments of a polyline are connected
+	enum LineJoin {
+		JoinMiter,	// extend the edges until they meet, falls back to bevel on sharp corners
+		JoinBevel,	// cut the corner with a straight edge
+		JoinRound	// round the corner with an arc
+	};
+
+	enum TextCacheMode {
+		NoTextCache,		// lay out strings on every call
+		TextCacheLayout,	// keep the laid out vertices of strings on the CPU
+		TextCacheGPU		// keep the laid out vertices inside a vertex buffer
+	};
+
+	// Counters of the draw submissions made by Graphics2D within a frame
+	struct FrameStatistics {
+		unsigned int draw_calls;	// number of draw calls issued to OpenGL
+		unsigned int flushes;		// number of batches submitted
+		unsigned int vertices;		// number of vertices submitted through batches
+		unsigned int sorted;		// number of deferred submissions sorted before flushing
+		unsigned int texture_changes_saved;	// texture switches avoided by sorting deferred submissions
+		unsigned int culled;		// number of draws rejected for being outside the camera
+		unsigned int drawn;			// number of draws that passed the culling test
+	};
+
+	// Load the shared resources, must be called once before any Graphics2D is created
 	static void InitResources();
 
+	// Get the statistics of the last completed frame
+	static FrameStatistics GetFrameStatistics();
+
+	// Evict cached strings that have not been drawn for the given number of frames
+	static void SetTextCacheLifetime(unsigned int frames);
+
+	// A Graphics2D only keeps the drawing state, so it could either live for a single frame
+	// or be kept as a long-lived context. State is sent to OpenGL lazily, only when it changes.
 	Graphics2D();
+	~Graphics2D();
+
+	// Collect draws into a shared vertex stream instead of submitting each of them immediately.
+	// The stream is flushed when the texture or view changes, or when Flush is called.
+	void SetBatching(bool enable);
 
+	// Submit all batched draws, also called on destruction and at the end of every frame
+	void Flush();
+
+	// Queue draws instead of streaming them in call order. Queued draws are sorted by layer, view,
+	// texture and depth on Flush, so interleaved content shares batches. Sprites and resident
+	// text runs are drawn immediately and submit the queue first.
+	void SetDeferred(bool enable);
+	void SetLayer(int layer); // from -32768 to 32767, lower layers are drawn first
+	void SetDepth(float depth); // from 0 to 1, lower depths are drawn first within a layer and texture
+	void SetKeepOrder(bool keep); // keep the call order within a layer instead of sorting by texture and depth
+
+	// Skip draws whose bounds lie outside the area seen by the camera, enabled by default.
+	// Sprites and command list replays are not culled.
+	void SetCulling(bool enable);
+
+	// Restrict drawing to a world rectangle through the scissor test, changing it breaks the batch
+	void SetClip(Fvec2 position, Fvec2 size);
+	void ClearClip();
+
+	// By default the projection follows the size of the window, or of the RenderTarget
+	// being drawn into, until it is set explicitly
 	void SetProjection(float width, float height);
 	void SetProjection(Fvec2 size);
+	void SetProjectionToWindow();
 
 	void SetCameraPosition(Fvec2 position);
 	void SetCameraPosition(float x, float y);
@@ -41,30 +105,90 @@ public:
 	void SetColor(unsigned int hex, float opacity = 1.0f);
 	void SetTexture(std::string const& name);
 	void SetTexture(Texture* texture);
+	void SetTexture(SubTexture const& sub_texture); // draws only the region of an atlas page
 	void SetGlowDirection(GlowDirection dir);
+	void SetOvalGood(unsigned int measure); // no effect, ovals and rings are covered analytically at any size
 
 	void SetRotation(float radian);
-	void SetOvalGood(unsigned int measure);
 	void SetLineWidth(float width);
+	void SetLineJoin(LineJoin join);
 	void SetFont(std::string const& name);
 	void SetFont(Font* font);
 	void SetTextAlignment(TextAlignment align);
+	void SetTextSize(float pixels); // zero uses the pixel size of the font
+	void SetTextCache(TextCacheMode mode);
 
 	void DrawRect(float x, float y, float width, float height);
 	void DrawRect(Fvec2 position, Fvec2 scale);
 	void DrawOval(float x, float y, float width, float height);
 	void DrawOval(Fvec2 position, Fvec2 scale);
+	void DrawRing(float x, float y, float width, float height, float thickness);
+	void DrawRing(Fvec2 position, Fvec2 scale, float thickness);
+	void DrawRoundedRect(float x, float y, float width, float height, float radius);
+	void DrawRoundedRect(Fvec2 position, Fvec2 scale, float radius);
 	void DrawLine(float x1, float y1, float x2, float y2);
 	void DrawLine(Fvec2 start, Fvec2 end);
+	void DrawPolyline(std::span<Fvec2 const> points);
+	void DrawPolygonOutline(std::span<Fvec2 const> points);
+
+	// Curves are flattened to within a quarter of a pixel at the current zoom, every contour is filled
+	// as a simple polygon and the texture, if any, is stretched over the bounding box of the path
+	void FillPath(Path2D const& path);
+	void StrokePath(Path2D const& path);
 	void DrawText(std::string const& str, float x, float y);
 
+	// Size of a string drawn with the current font and text size, the height is the tallest glyph
+	Fvec2 MeasureText(std::string_view str) const;
+
 private:
 	Shader& shader;
-	float rotation;
-	unsigned int oval_measure;
+	Fvec2 projection, camera_position, camera_zoom;
+	Fmat4 view;
+	std::uint64_t view_id;
+	bool auto_projection;
+	float rotation, rotation_cos, rotation_sin;
 	float line_width;
+	LineJoin line_join;
 	Font* font;
 	TextAlignment align;
+	TextCacheMode text_cache;
+	float text_size;
+	Fvec4 color;
+	Texture* texture;
+	SubTexture const* sub_texture;
+	GlowDirection glow;
+	bool batching;
+	CommandList2D* recording;
+	bool deferred, keep_order;
+	int layer;
+	float depth;
+	bool culling;
+	Fvec4 visible; // world rectangle seen by the camera: min x, min y, max x, max y
+	Ivec4 clip; // scissor rectangle in framebuffer pixels, negative width if disabled
+
+private:
+	void UpdateView();
+	bool Cull(Fvec2 center, Fvec2 extent); // true if the box is outside the view, extent is half its size
+	float* BatchVertices(int count, Texture* texture);
+	void DrawShape(Fvec2 position, Fvec2 scale, float shape, float param);
+	void DrawStroke(std::span<Fvec2 const> points, bool closed);
+	void TessellatePath(Path2D const& path);
+
+	// Flush the vertex stream and issue a draw from elsewhere with the shader prepared for it.
+	// In RedrawMode::Damaged the draw runs once the damage of the frame is known, so it must own
+	// copies of whatever it reads that could change within the frame.
+	// @param source: the u_source of the draw, as listed in default.vert.glsl
+	// @param fill: the u_fill of the draw, as listed in default.frag.glsl
+	void ExternalDraw(int source, Texture* texture, int fill, std::function<void(Shader&)> draw);
+	static void SendExternalColor(Fvec4 const& color, GlowDirection glow = NoGlow);
+
+	// Fold a draw issued from elsewhere into the damage tracker of RedrawMode::Damaged
+	// @param bounds: (min x, min y, max x, max y) in world space
+	// @param hash: changes whenever the content of the draw changes
+	void ReportExternalDraw(Fvec4 const& bounds, std::uint64_t hash);
+	friend class SpriteBatch;
+	friend class CommandList2D;
+	friend class Tilemap;
 };
 
 }
\ No newline at end of file
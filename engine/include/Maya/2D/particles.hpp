@@ -0,0 +1,60 @@
+#pragma once
+
+#include "./graphics.hpp"
+
+namespace Maya {
+
+// Particles stored as one array per attribute and updated with vectorized loops.
+// Storage is allocated once for the capacity, dead particles are compacted in place.
+// Particles are drawn through the instanced sprite path of SpriteBatch.
+class ParticleEmitter
+{
+public:
+	// @param capacity: maximum number of particles alive at the same time
+	ParticleEmitter(unsigned int capacity);
+
+	// @param texture: the texture of every particle, nullptr to draw with color only
+	void SetTexture(Texture* texture);
+	void SetPosition(Fvec2 position);
+	void SetRate(float per_second); // particles emitted continuously during Update
+	void SetLifetime(float min, float max); // in seconds
+	void SetSpeed(float min, float max);
+	void SetDirection(float radian, float spread); // particles leave within direction +- spread / 2
+	void SetSpin(float min, float max); // angular velocity in radian per second
+	void SetGravity(Fvec2 acceleration);
+	void SetDrag(float drag); // fraction of velocity lost per second
+	void SetColor(Fvec4 start, Fvec4 end); // interpolated over the lifetime
+	void SetSize(Fvec2 start, Fvec2 end); // interpolated over the lifetime
+
+	// Spawn particles at the emitter position, ignored once the capacity is reached
+	void Emit(unsigned int count);
+
+	// Advance every particle, emit new ones and remove the dead ones
+	// @param dt: elapsed time in seconds
+	void Update(float dt);
+
+	void Draw(Graphics2D& g) const;
+	void Clear();
+
+	unsigned int Size() const;
+	unsigned int Capacity() const;
+
+private:
+	std::vector<Fvec2> positions, velocities, scales;
+	std::vector<Fvec4> colors;
+	std::vector<float> rotations, spins, ages, inv_lifetimes;
+	unsigned int count, capacity;
+
+	Texture* texture;
+	Fvec2 position, gravity;
+	float rate, pending;
+	float lifetime[2], speed[2], spin[2];
+	float direction, spread, drag;
+	Fvec4 color_start, color_end;
+	Fvec2 size_start, size_end;
+	std::uint32_t seed;
+
+	float Random(); // uniform in [0, 1)
+};
+
+}
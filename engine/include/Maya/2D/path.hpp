@@ -0,0 +1,45 @@
+#pragma once
+
+#include "./graphics.hpp"
+
+namespace Maya {
+
+// A sequence of contours made of lines and Bezier curves, drawn with Graphics2D::FillPath and
+// Graphics2D::StrokePath. Curves are flattened according to the on-screen size of the path and
+// the result is kept until the path is edited or the zoom changes by more than a factor of two.
+class Path2D
+{
+public:
+	Path2D();
+
+	// Start a new contour
+	void MoveTo(Fvec2 point);
+	void LineTo(Fvec2 point);
+	void QuadraticTo(Fvec2 control, Fvec2 end);
+	void CubicTo(Fvec2 control1, Fvec2 control2, Fvec2 end);
+
+	// Connect the current contour back to its first point
+	void Close();
+	void Clear();
+
+private:
+	enum Verb : std::uint8_t { Move, Line, Quadratic, Cubic, CloseContour };
+	std::vector<Verb> verbs;
+	std::vector<Fvec2> points;
+
+	// tessellation cache
+	struct Contour { int first, count; bool closed; };
+	mutable std::vector<Fvec2> flattened;
+	mutable std::vector<Contour> contours;
+	mutable std::vector<float> fill; // triangles of position (2), texture coordinate (2), local (2)
+	mutable Fvec4 bounds; // min x, min y, max x, max y
+	mutable float tolerance;
+	mutable bool fill_valid;
+
+	void Flatten(float tolerance) const;
+	void Triangulate() const;
+	void Invalidate();
+	friend class Graphics2D;
+};
+
+}
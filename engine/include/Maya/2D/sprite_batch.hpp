@@ -0,0 +1,49 @@
+#pragma once
+
+#include "./graphics.hpp"
+
+namespace Maya {
+
+// Sprites stored as contiguous arrays, drawn with instanced draw calls of a unit square.
+// Every sprite is transformed in the vertex shader, so submitting them is only a copy of each array.
+class SpriteBatch
+{
+public:
+	// Default texture rectangle, covers the whole texture
+	static constexpr Fvec4 FullRect = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+	// @param texture: the texture (or atlas) of every sprite, nullptr to draw with color only
+	SpriteBatch(Texture* texture = nullptr);
+
+	void SetTexture(Texture* texture);
+	void Reserve(unsigned int count);
+	void Clear();
+
+	// Add a sprite, returns its index inside the arrays
+	// @param rect: texture rectangle (min u, min v, max u, max v)
+	unsigned int Push(Fvec2 position, Fvec2 scale, float rotation = 0.0f,
+		Fvec4 color = Fvec4(1.0f), Fvec4 rect = FullRect);
+
+	unsigned int Size() const;
+
+	// Draw every sprite with the camera and projection of a Graphics2D
+	void Draw(Graphics2D& g) const;
+
+	// Draw sprites directly from contiguous arrays of count elements each
+	// @param rotations, colors, rects: could be nullptr to use zero, white and FullRect
+	static void Draw(Graphics2D& g, Texture* texture, unsigned int count,
+		Fvec2 const* positions, Fvec2 const* scales, float const* rotations = nullptr,
+		Fvec4 const* colors = nullptr, Fvec4 const* rects = nullptr);
+
+public:
+	std::vector<Fvec2> positions;
+	std::vector<Fvec2> scales;
+	std::vector<float> rotations;
+	std::vector<Fvec4> colors;
+	std::vector<Fvec4> rects;
+
+private:
+	Texture* texture;
+};
+
+}
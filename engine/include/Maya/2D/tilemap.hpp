@@ -0,0 +1,55 @@
+#pragma once
+
+#include "./graphics.hpp"
+
+namespace Maya {
+
+// A grid of tiles taken from a tileset texture. Tiles are grouped into chunks of
+// ChunkSize x ChunkSize, each stored inside its own vertex buffer, so drawing costs
+// one draw call per chunk seen by the camera. Editing a tile only rebuilds its chunk.
+class Tilemap
+{
+public:
+	static constexpr int ChunkSize = 32;
+	static constexpr int Empty = -1;
+
+	// @param size: number of tiles along x and y
+	// @param tile_size: size of a tile in world units
+	// @param tileset: texture containing the tiles
+	// @param grid: number of columns and rows of tiles inside the tileset,
+	//              tile indices start from the top left and go row by row
+	Tilemap(Ivec2 size, Fvec2 tile_size, Texture* tileset, Ivec2 grid);
+	~Tilemap();
+
+	// Set a tile, Empty to leave it blank. Tile (0, 0) is the bottom left one.
+	void SetTile(int x, int y, int tile);
+	int GetTile(int x, int y) const;
+	void Fill(int tile);
+
+	// Position of the bottom left corner of the map in world space
+	void SetPosition(Fvec2 position);
+	Fvec2 GetPosition() const;
+	Ivec2 GetSize() const;
+
+	// Draw the chunks seen by the camera of a Graphics2D
+	// @param tint: multiplied with the color of every tile
+	void Draw(Graphics2D& g, Fvec4 const& tint = Fvec4(1.0f));
+
+private:
+	// revision changes on every edit, it tells RedrawMode::Damaged which chunks to redraw
+	struct Chunk { VertexArray* vao = nullptr; int count = 0; bool dirty = true; std::uint64_t revision = 0; };
+
+	Ivec2 size, chunks;
+	Fvec2 tile_size, position;
+	Texture* tileset;
+	Ivec2 grid;
+	std::vector<int> tiles;
+	std::vector<Chunk> chunk_data;
+
+	void Build(int cx, int cy);
+
+	Tilemap(Tilemap const&) = delete;
+	Tilemap& operator=(Tilemap const&) = delete;
+};
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "./graphics.hpp"
+#include "../event.hpp"
+
+namespace Maya {
+
+// Immediate mode widgets drawn through a Graphics2D of their own. Widgets are declared every frame
+// between Begin and End and report interactions through their return values. Everything goes into
+// the shared vertex stream with cached text, panels and scroll regions clip with the scissor test,
+// so a whole interface costs about one draw call per clipped region.
+// Positions and sizes are in window pixels, with the origin at the top left corner.
+//
+//	ui.Begin();
+//	ui.BeginPanel("Debug", Fvec2(10, 10), Fvec2(240, 300));
+//	if (ui.Button("Reset")) Reset();
+//	ui.Slider("Speed", speed, 0.0f, 10.0f);
+//	ui.EndPanel();
+//	ui.End();
+class UserInterface
+{
+public:
+	// Must be created after Graphics2D::InitResources
+	UserInterface();
+
+	// Feed window events, expected to be called from Scene::OnEvent
+	void OnEvent(Event const& e);
+
+	void Begin();
+	void End();
+
+	// A titled window, widgets inside are stacked from top to bottom
+	void BeginPanel(std::string const& title, Fvec2 position, Fvec2 size);
+	void EndPanel();
+
+	// A region of the given height inside a panel, scrolls with the mouse wheel when its content is taller
+	void BeginScroll(std::string const& id, float height);
+	void EndScroll();
+
+	void Label(std::string const& text);
+
+	// Returns true when clicked
+	bool Button(std::string const& label);
+
+	// Returns true when the value is changed
+	bool Slider(std::string const& label, float& value, float min, float max);
+
+	// Returns true when the text is changed, only printable ascii characters are accepted
+	bool TextField(std::string const& label, std::string& text);
+
+	// Check if the cursor was over a panel during the last frame, so the scene could ignore the input
+	bool WantsMouse() const;
+
+private:
+	// A panel or a scroll region, rect is (x, y, width, height) in window pixels
+	struct Container
+	{
+		Fvec4 rect, clip;
+		float cursor;
+		std::uint64_t id;
+	};
+
+	Graphics2D g;
+	std::vector<Container> containers;
+	std::unordered_map<std::uint64_t, Fvec2> scrolls; // offset and content height of each scroll region
+	std::uint64_t active, focused;
+	Fvec2 window, mouse;
+	float wheel;
+	bool mouse_down, mouse_pressed, mouse_released;
+	bool over_panel, wants_mouse, focus_claimed;
+	std::string typed;
+	std::vector<KeyCode> keys;
+
+	std::uint64_t MakeID(std::string_view label) const;
+	Fvec4 NextRow(float height);
+	bool Hovered(Fvec4 const& rect) const;
+	void Clip(Fvec4 const& rect);
+	void FillRect(Fvec4 const& rect, unsigned int hex, float opacity = 1.0f, float radius = 0.0f);
+	void Text(std::string const& str, float x, float y, Graphics2D::TextAlignment align);
+};
+
+}
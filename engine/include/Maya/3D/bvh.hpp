@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../math.hpp"
+
+namespace Maya {
+
+// The six planes of a view frustum, points inside satisfy Dot(normal, point) + distance >= 0
+struct Frustum final
+{
+	Fvec4 planes[6]; // left, right, bottom, top, near, far as (normal, distance)
+
+	Frustum() = default;
+
+	// Extract the planes from a projection * view matrix, e.g. PerspectiveProjection(...) * LookAt(...)
+	explicit Frustum(Fmat4 const& view_projection);
+
+	// Conservative test, could report boxes near the corners of the frustum as visible
+	bool Intersects(Fvec3 min, Fvec3 max) const;
+};
+
+// Bounding box of a transformed box, e.g. a model matrix applied to the bounds of a mesh
+void TransformBounds(Fmat4 const& transform, Fvec3& min, Fvec3& max);
+
+// Dynamic bounding volume hierarchy of world space boxes, used for visibility determination.
+// Boxes are stored enlarged by a margin, so small movements change nothing and larger
+// ones reinsert a single leaf and refit its ancestors, balanced with rotations on the way up.
+//
+//	int proxy = bvh.Insert(min, max, object_index);
+//	bvh.Move(proxy, new_min, new_max);
+//	bvh.Cull(Frustum(projection * view), visible);
+class BoundingVolumeHierarchy final
+{
+public:
+	// @param margin: distance the stored boxes are enlarged by on every side
+	BoundingVolumeHierarchy(float margin = 0.1f);
+
+	// Add a box, returns a proxy identifying it
+	// @param value: user value reported by Cull, e.g. an index into the objects of a scene
+	int Insert(Fvec3 min, Fvec3 max, std::uint32_t value);
+
+	void Remove(int proxy);
+
+	// Update the box of a proxy, returns true if the leaf had to be reinserted
+	bool Move(int proxy, Fvec3 min, Fvec3 max);
+
+	// Append the value of every box intersecting the frustum
+	void Cull(Frustum const& frustum, std::vector<std::uint32_t>& visible) const;
+
+	void Clear();
+
+	std::uint32_t GetValue(int proxy) const;
+	int GetProxyCount() const;
+	int GetHeight() const;
+
+private:
+	// What culling reads is packed into 32 bytes, the children share the lanes
+	// of the bounds left over by SIMD loads
+	struct Node
+	{
+		alignas(16) float min[3];
+		int child1; // -1 for leaves
+		float max[3];
+		int child2; // the user value for leaves
+	};
+
+	struct Link
+	{
+		int parent; // next free node when the node is unused
+		int height; // -1 for unused nodes
+	};
+
+	std::vector<Node> nodes;
+	std::vector<Link> links;
+	int root, free_list, proxy_count;
+	float margin;
+
+	int Allocate();
+	void Free(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int node);
+	void Refit(int node);
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../event.hpp"
+#include "./bvh.hpp"
+
+namespace Maya {
+
+// A perspective camera whose matrices live in a uniform buffer shared by every 3D shader.
+// Matrices are only recomputed after a change and uploaded when the camera is updated,
+// so drawing with it costs nothing per draw call. Shaders read it through
+//
+//	layout (std140, row_major) uniform Maya_Camera {
+//		mat4 u_projection, u_view, u_view_projection;
+//		vec4 u_camera_position;
+//	};
+//
+// bound to Camera::UniformBinding, see Shader::BindUniformBlock.
+class Camera final
+{
+public:
+	// Uniform buffer binding point of the camera block
+	static constexpr int UniformBinding = 0;
+
+	// The aspect ratio follows the current viewport, i.e. the window or the RenderTarget
+	// being drawn into, until it is set explicitly
+	Camera(Fvec3 position = Fvec3(0.0f), Fvec3 orientation = Fvec3(0.0f, 0.0f, -1.0f),
+		float fovy = 3.1415926536f / 3, float near = 0.1f, float far = 100.0f);
+
+	// Follows WindowResizedEvent, the viewport is already polled so forwarding events is optional
+	void OnEvent(Event const& e);
+
+	void SetPosition(Fvec3 position);
+	void SetOrientation(Fvec3 orientation, Fvec3 up = Fvec3(0.0f, 1.0f, 0.0f));
+	void SetPerspective(float fovy, float near, float far);
+	void SetAspectRatio(float aspect);
+	void SetAspectRatioToViewport();
+
+	// Recompute the matrices if anything changed, then make this camera the one in the uniform buffer.
+	// Uploads only when the buffer holds an older state, so calling it before every draw is cheap.
+	void Update();
+
+	Fvec3 GetPosition() const;
+	Fvec3 GetOrientation() const;
+	float GetFieldOfView() const;
+	float GetAspectRatio() const;
+	Fmat4 const& GetProjection() const;
+	Fmat4 const& GetView() const;
+	Fmat4 const& GetViewProjection() const;
+	Frustum const& GetFrustum() const;
+
+private:
+	Fvec3 position, orientation, up;
+	float fovy, near, far;
+	mutable float aspect;
+	bool auto_aspect;
+	mutable Fmat4 projection, view, view_projection;
+	mutable Frustum frustum;
+	mutable std::uint64_t revision;
+	mutable bool dirty;
+
+	void Recompute() const;
+};
+
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../shader.hpp"
+#include "./mesh.hpp"
+#include "./camera.hpp"
 
 namespace Maya {
 
@@ -16,8 +18,34 @@ public:
 	Graphics3D();
 	void DrawCube(float elapsed);
 
+	// The camera every draw call goes through, updated lazily before drawing
+	Camera& GetCamera();
+
+	// Texture used by the following instanced draws, plain white until set
+	void SetTexture(Texture& texture);
+
+	// Draw a mesh at the level of detail fitting its size on screen
+	// @param lod: level drawn by the previous frame, updated to keep the choice stable, could be nullptr
+	void DrawMesh(Mesh& mesh, Fmat4 const& model, int* lod = nullptr);
+
+	// Draw a mesh once for every model matrix, with one draw call per level of detail in use
+	// @param lods: level of every instance drawn by the previous frame, updated like DrawMesh.
+	//              Without it levels are picked without hysteresis.
+	void DrawInstanced(Mesh& mesh, std::span<Fmat4 const> models, std::span<std::uint8_t> lods = {});
+
+	// Diameter in pixels of the bounding sphere of a mesh drawn with a model matrix
+	float GetScreenSize(Mesh const& mesh, Fmat4 const& model) const;
+
+	// Error in pixels a level of detail is allowed to cause
+	void SetLodTolerance(float pixels);
+
 private:
 	Shader& shader;
+	Shader& instanced_shader;
+	Texture* texture;
+	Camera camera;
+	float lod_tolerance;
+	std::vector<Fmat4> sorted_models;
 };
 
 }
\ No newline at end of file
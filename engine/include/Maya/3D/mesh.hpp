@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../vertex_array.hpp"
+#include <future>
+#include <span>
+
+namespace Maya {
+
+// A level of detail, a range of the shared index buffer
+struct MeshLod final
+{
+	unsigned int first, count; // range of indices
+	float error; // largest distance from the full mesh, in object space
+};
+
+// Geometry in memory, interleaved as VertexLayout(3, 3, 2): position, normal, texture coordinate
+struct MeshData final
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices; // every level of detail, one after another
+	std::vector<MeshLod> lods; // from the full mesh to the coarsest, empty if indices hold a single level
+	Fvec3 min, max; // bounding box of the positions
+};
+
+// Reduce the triangles of an index list with quadric error metrics. Edges collapse onto existing
+// vertices, so the result indexes the same vertex buffer
+// @param indices: triangles to simplify, referring to data.vertices
+// @param target_index_count: stops once the result has at most this many indices, or no collapse is left
+// @param error: receives the largest error introduced, in object space
+std::vector<unsigned int> SimplifyMesh(MeshData const& data, std::span<unsigned int const> indices,
+	std::size_t target_index_count, float* error = nullptr);
+
+// Replace data.lods with a chain of simplified levels appended to data.indices
+// @param max_levels: number of levels including the full mesh
+// @param reduction: fraction of the triangles of the previous level each one aims for
+void GenerateLods(MeshData& data, int max_levels = 4, float reduction = 0.5f);
+
+// Indexed triangles loaded from a Wavefront OBJ or a binary glTF (.glb) file.
+// Parsing is split across worker threads and identical vertices are merged through a hash table,
+// so loading stays linear in the size of the file.
+class Mesh final
+{
+public:
+	// Load a file and upload it, must be called from the thread owning the window
+	Mesh(std::string const& path);
+
+	// Upload geometry that was already loaded, e.g. by LoadAsync
+	Mesh(MeshData const& data);
+
+	// Release the vertex array and its buffers
+	~Mesh();
+
+	// Parse a file without touching OpenGL, so it could be called from any thread
+	// @param lods: whether to generate levels of detail with GenerateLods
+	// @returns false if the file cannot be read or its format is not supported
+	static bool Load(std::string const& path, MeshData& data, bool lods = true);
+
+	// Parse a file on another thread, the result is passed to the constructor once ready
+	static std::future<MeshData> LoadAsync(std::string const& path, bool lods = true);
+
+	void Draw(int lod = 0);
+
+	// Draw the mesh once for every model matrix, in a single draw call.
+	// Matrices are streamed into a per instance buffer at attribute locations 3 to 6.
+	void DrawInstanced(std::span<Fmat4 const> models, int lod = 0);
+
+	// Pick a level of detail for a projected size, so its error covers less than the tolerance in pixels.
+	// Coarser levels are only taken once their error falls clearly below the tolerance,
+	// which stops the level switching back and forth around the threshold
+	// @param screen_size: diameter of the bounding sphere on screen, in pixels
+	// @param current: level drawn previously, -1 if none
+	int SelectLod(float screen_size, int current = -1, float tolerance = 1.0f) const;
+
+	// A mesh without indices has no vertex array, check GetIndexCount first
+	VertexArray& GetVertexArray() const;
+	int GetVertexCount() const;
+	int GetIndexCount(int lod = 0) const;
+	int GetLodCount() const;
+	MeshLod const& GetLod(int lod) const;
+	Fvec3 GetBoundsMin() const;
+	Fvec3 GetBoundsMax() const;
+
+	// Bounding sphere around the center of the bounding box
+	Fvec3 GetCenter() const;
+	float GetRadius() const;
+
+private:
+	VertexArray* vao;
+	int vertex_count;
+	std::vector<MeshLod> lods;
+	Fvec3 min, max;
+
+	Mesh(Mesh const&) = delete;
+	Mesh& operator=(Mesh const&) = delete;
+};
+
+}
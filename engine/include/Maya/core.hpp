@@ -34,4 +34,7 @@
 #include <concepts>
 #include <cmath>
 #include <stdexcept>
-#include <memory>
\ No newline at end of file
+#include <memory>
+#include <algorithm>
+#include <span>
+#include <cstring>
\ No newline at end of file
@@ -200,7 +200,7 @@ struct MouseMovedEvent : public Event
 struct MouseScrolledEvent : public Event
 {
 	MAYA_EVENT_TYPE(3)
-	MouseScrolledEvent(Ivec2 position) : offset(offset) {}
+	MouseScrolledEvent(Ivec2 offset) : offset(offset) {}
 	Ivec2 offset; // mouse offset
 };
 
@@ -234,6 +234,14 @@ struct WindowMovedEvent : public Event
 	Ivec2 position; // current window position
 };
 
+// When users type a character, after keyboard layout and modifiers are applied
+struct CharEvent : public Event
+{
+	MAYA_EVENT_TYPE(8)
+	CharEvent(unsigned int codepoint) : codepoint(codepoint) {}
+	unsigned int codepoint; // unicode code point of the character
+};
+
 #undef MAYA_EVENT_TYPE
 
 }
\ No newline at end of file
@@ -7,7 +7,8 @@ namespace Maya {
 // Stores the glyph data of each character
 struct Glyph final
 {
-	Texture* texture;
+	Texture* texture; // the atlas texture shared by all glyphs of the font
+	Fvec2 uv_min, uv_max; // texture coordinates of the glyph inside the atlas
 	Ivec2 size, bearing;
 	unsigned advance;
 };
@@ -17,13 +18,26 @@ class Font final
 public:
 	// Load a truetype font through a filepath
 	// @param pixel_size: the size of the pixel to be loaded
-	Font(std::string const& path, int pixel_size);
+	// @param sdf: rasterize glyphs as signed distance fields, which stay sharp when scaled
+	Font(std::string const& path, int pixel_size, bool sdf = false);
 
 	// Get a character glyph from the font
 	Glyph operator[](unsigned char c) const;
 
+	// Get the atlas texture containing every glyph
+	Texture* GetAtlas() const;
+
+	// Get the pixel size the glyphs were rasterized with
+	int GetPixelSize() const;
+
+	// Check if the glyphs are signed distance fields
+	bool IsSDF() const;
+
 private:
 	std::unordered_map<unsigned char, Glyph> glyphs;
+	Texture* atlas;
+	int pixel_size;
+	bool sdf;
 	~Font();
 	Font(Font const&) = delete;
 	Font& operator=(Font const&) = delete;
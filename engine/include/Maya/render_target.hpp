@@ -0,0 +1,64 @@
+#pragma once
+
+#include "./texture.hpp"
+
+namespace Maya {
+
+// An offscreen framebuffer that Graphics2D and Graphics3D can draw into, e.g. to cache layers that rarely change.
+// The result is an ordinary texture, composited back with a single textured quad:
+//
+//	if (dirty) {
+//		background.Begin();
+//		DrawBackground(g);
+//		background.End();
+//	}
+//	g.SetTexture(&background.GetTexture());
+//	g.DrawRect(Fvec2(0.0f), Fvec2(GetWindowSize()));
+//
+// Colors are blended into the target with the usual alpha blending, so translucent
+// content loses some of its alpha when composited; opaque layers are not affected.
+class RenderTarget final
+{
+public:
+	// @param size: size of the target in pixels, zero to follow the window size
+	// @param samples: number of samples per pixel, the target is resolved into its texture by End
+	// @param depth_stencil: attach a depth and stencil buffer, needed by Graphics3D
+	RenderTarget(Ivec2 size = Ivec2(0), int samples = 1, bool depth_stencil = false);
+	~RenderTarget();
+
+	// Redirect the following draws into this target until End is called, targets could be nested
+	// @param clear: clear the color (and depth and stencil) buffers
+	void Begin(bool clear = true);
+
+	// Resolve the samples and restore the framebuffer that was bound before Begin
+	void End();
+
+	// Reallocate the buffers, the content becomes undefined
+	void Resize(Ivec2 size);
+
+	// Get the color texture, valid after End
+	Texture& GetTexture();
+
+	// Get the size of the target in pixels
+	Ivec2 GetSize() const;
+
+private:
+	unsigned int framebuffer, resolve_framebuffer;
+	unsigned int color_buffer, depth_buffer; // renderbuffers, the color one is used with multisampling only
+	Texture* texture;
+	Ivec2 size;
+	int samples;
+	bool depth_stencil, follow_window;
+
+	// state restored by End
+	unsigned int previous_framebuffer;
+	Ivec4 previous_viewport;
+
+	void Allocate();
+
+	friend class PrivateControl;
+	RenderTarget(RenderTarget const&) = delete;
+	RenderTarget& operator=(RenderTarget const&) = delete;
+};
+
+}
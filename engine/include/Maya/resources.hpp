@@ -3,6 +3,8 @@
 #include "./vertex_array.hpp"
 #include "./shader.hpp"
 #include "./texture.hpp"
+#include "./texture_atlas.hpp"
+#include "./render_target.hpp"
 #include "./font.hpp"
 #include "./audio_stream.hpp"
 
@@ -20,6 +22,7 @@ public:
 	MAYA_RESOURCES_MANAGER_CREATE_FUNC(VertexArray, vaos)
 	MAYA_RESOURCES_MANAGER_CREATE_FUNC(Shader, shaders)
 	MAYA_RESOURCES_MANAGER_CREATE_FUNC(Texture, textures)
+	MAYA_RESOURCES_MANAGER_CREATE_FUNC(RenderTarget, render_targets)
 	MAYA_RESOURCES_MANAGER_CREATE_FUNC(Font, fonts)
 	MAYA_RESOURCES_MANAGER_CREATE_FUNC(AudioStream, audio_streams)
 
@@ -31,17 +34,30 @@ public:
 	MAYA_RESOURCES_MANAGER_GET_FUNC(VertexArray, vaos)
 	MAYA_RESOURCES_MANAGER_GET_FUNC(Shader, shaders)
 	MAYA_RESOURCES_MANAGER_GET_FUNC(Texture, textures)
+	MAYA_RESOURCES_MANAGER_GET_FUNC(RenderTarget, render_targets)
 	MAYA_RESOURCES_MANAGER_GET_FUNC(Font, fonts)
 	MAYA_RESOURCES_MANAGER_GET_FUNC(AudioStream, audio_streams)
 
 #undef MAYA_RESOURCES_MANAGER_GET_FUNC
 
+	// Load an image into the shared texture atlas instead of its own texture,
+	// so that it can be drawn along with other sub textures without rebinding
+	SubTexture const* CreateSubTexture(std::string const& name, std::string const& path);
+	SubTexture const* CreateSubTexture(std::string const& name, std::uint8_t const* data, Ivec2 size, int channels);
+	SubTexture const& GetSubTexture(std::string const& name) { return *sub_textures.at(name); }
+
+	// Get the atlas holding every sub texture, e.g. to inspect page occupancy
+	TextureAtlas& GetTextureAtlas() { return atlas; }
+
 private:
 	std::unordered_map<std::string, VertexArray> vaos;
 	std::unordered_map<std::string, Shader> shaders;
 	std::unordered_map<std::string, Texture> textures;
+	std::unordered_map<std::string, RenderTarget> render_targets;
 	std::unordered_map<std::string, Font> fonts;
 	std::unordered_map<std::string, AudioStream> audio_streams;
+	std::unordered_map<std::string, SubTexture const*> sub_textures;
+	TextureAtlas atlas;
 
 private:
 	ResourcesManager();
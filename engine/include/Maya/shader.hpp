@@ -32,6 +32,10 @@ public:
 	// Bind shader
 	void Bind();
 
+	// Read a uniform block from a uniform buffer binding point, e.g. Camera::UniformBinding
+	// @param name: the name of the block, ignored if the shader does not declare it
+	void BindUniformBlock(std::string const& name, int binding);
+
 private:
 	unsigned int shaderid;
 	std::unordered_map<std::string, int> uniform_location_cache;
@@ -22,6 +22,19 @@ public:
 	// @param slot: indicates which texture slot to bind
 	void Bind(int slot);
 
+	// Replace a region of the texture
+	// @param data: the array pointer of image, covering the region only
+	// @param offset: bottom left corner of the region
+	// @param size: size of the region
+	// @param channels: number of channels of image, expects 1 to 4
+	void Update(std::uint8_t const* data, Ivec2 offset, Ivec2 size, int channels);
+
+	// Reallocate the texture with a new size, the content becomes undefined
+	void Resize(Ivec2 size);
+
+	// Get the size of the texture in pixels
+	Ivec2 GetSize() const;
+
 private:
 	std::uint32_t textureid;
 	Ivec2 size;
@@ -32,6 +45,8 @@ private:
 	~Texture();
 	friend class PrivateControl;
 	friend class Font;
+	friend class TextureAtlas;
+	friend class RenderTarget;
 };
 
 }
\ No newline at end of file
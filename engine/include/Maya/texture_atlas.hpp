@@ -0,0 +1,60 @@
+#pragma once
+
+#include "./texture.hpp"
+
+namespace Maya {
+
+// A rectangle inside one of the pages of a texture atlas
+struct SubTexture final
+{
+	Texture* page; // the atlas page containing the image
+	Fvec2 uv_min, uv_max; // texture coordinates of the image inside the page
+	Ivec2 size; // size of the image in pixels
+
+	// Get the uv rectangle as (min u, min v, max u, max v), as used by SpriteBatch
+	Fvec4 GetRect() const;
+};
+
+// Packs many small images into a few large textures, so that
+// sprites using different images can be drawn without rebinding.
+// Pages start small and grow as images are added, until they reach
+// the maximum size and a new page is opened.
+class TextureAtlas final
+{
+public:
+	// @param max_page_size: the largest size a page is allowed to grow to
+	// @param padding: empty pixels kept around every image to avoid bleeding
+	TextureAtlas(Ivec2 max_page_size = Ivec2(2048, 2048), int padding = 1);
+	~TextureAtlas();
+
+	// Pack an image into the atlas
+	// @param data: the array pointer of image
+	// @param size: size of that image
+	// @param channels: number of channels of image, expects 1 to 4
+	// @returns a handle that stays valid as long as the atlas lives,
+	//          its uv rectangle is updated whenever the page grows
+	SubTexture const* Add(std::uint8_t const* data, Ivec2 size, int channels);
+
+	// Load an image from file and pack it into the atlas
+	SubTexture const* Add(std::string const& path);
+
+	// Get the number of pages currently allocated
+	int GetPageCount() const;
+
+	// Get a page texture
+	Texture* GetPage(int index) const;
+
+	// Get the fraction of a page covered by images, including padding
+	float GetPageOccupancy(int index) const;
+
+private:
+	struct Page;
+	std::vector<std::unique_ptr<Page>> pages;
+	Ivec2 max_page_size;
+	int padding;
+
+	TextureAtlas(TextureAtlas const&) = delete;
+	TextureAtlas& operator=(TextureAtlas const&) = delete;
+};
+
+}
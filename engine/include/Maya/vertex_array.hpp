@@ -32,27 +32,77 @@ struct VertexLayout final
 	struct Attribute final { int count, offset; };
 	std::vector<Attribute> attributes;
 	int stride = 0;
+
+	int location = -1;	// location of the first attribute, follows the previous buffer if negative
+	int divisor = 0;	// attributes advance once every divisor instances, zero for per vertex attributes
+	int count = 0;		// number of elements inside the buffer, uses the vertex count if zero
 };
 
+// Pairs of vertex data and its layout, a nullptr data allocates a dynamic buffer instead
 using VertexDataStruct = std::vector<std::pair<float*, VertexLayout>>;
 
 class VertexArray
 {
 public:
+	// Create the buffers of every pair in vds and link their attributes
+	// @param vds: vertex data and layouts, each pair becomes its own buffer
+	// @param count: number of vertices, also the element count of buffers whose layout leaves it zero
+	// @param primitive: how vertices are assembled when drawn
+	// OpenGL objects live until the program exits, so engine code keeps heap allocated
+	// vertex arrays in pools rather than deleting them
+	VertexArray(VertexDataStruct& vds, int count, Primitives primitive = Primitives::Triangles);
+
+	// Same as above with an index buffer
+	// @param ibo: array of indices into the vertices
+	// @param ibosize: number of indices
+	VertexArray(VertexDataStruct& vds, int count, Primitives primitive, unsigned int* ibo, unsigned int ibosize);
+
 	void Bind();
 	void Unbind();
 	void Draw();
 
+	// Draw a range of vertices (ignores the index buffer)
+	// @param first: index of the first vertex
+	// @param count: number of vertices to be drawn
+	void Draw(int first, int count);
+
+	// Draw every vertex once for each instance
+	// @param instances: number of instances to be drawn
+	void DrawInstanced(int instances);
+
+	// Draw a range of the index buffer
+	// @param first: position of the first index
+	// @param count: number of indices to be drawn
+	void DrawElements(int first, int count);
+
+	// Draw a range of the index buffer once for each instance
+	void DrawElementsInstanced(int first, int count, int instances);
+
+	// Replace the content of a vertex buffer from its first element,
+	// the storage is only reallocated when it grows
+	// @param index: the index of the buffer inside VertexDataStruct
+	// @param data: vertex data following the buffer layout
+	// @param count: number of elements, the buffer grows when it exceeds the element count
+	void UpdateVBO(int index, float const* data, int count);
+
+	// Delete the OpenGL objects right away instead of at exit, for vertex arrays owned by a single object.
+	// The vertex array must not be drawn afterwards.
+	void Release();
+
+	// Append to a vertex buffer used as a ring, for data drawn once and then discarded.
+	// Written ranges are never in flight, the storage is orphaned only when the ring wraps.
+	// @return the position of the first written element, to be passed to Draw
+	int StreamVBO(int index, float const* data, int count);
+
 private:
 	unsigned int vaoid, iboid;
 	std::vector<std::uint32_t> vboids;
+	std::vector<int> vbostrides, vbocounts, vbooffsets;
 	unsigned int attribloc;
 	int vertex_count, elem_to_draw;
 	Primitives primitives;
 
 private:
-	VertexArray(VertexDataStruct& vds, int count, Primitives primitive = Primitives::Triangles);
-	VertexArray(VertexDataStruct& vds, int count, Primitives primitive, unsigned int* ibo, unsigned int ibosize);
 	friend class ResourcesManager;
 };
 
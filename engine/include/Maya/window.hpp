@@ -16,4 +16,31 @@ Ivec2 GetWindowSize();
 
 std::string GetWindowTitle();
 
+enum class RedrawMode
+{
+	Full,		// clear and redraw the whole window every frame
+	Damaged		// redraw only where Graphics2D draws changed, present nothing if the frame did not change
+};
+
+// In RedrawMode::Damaged the last frame is kept in an offscreen canvas and the scene draws as usual.
+// Graphics2D draws into the window are held back until the frame ends, then the GPU only redraws the
+// bounding rectangle of what changed, covering both the old and the new place of moved content.
+// Vertex buffers drawn by reference, i.e. tilemap chunks, command lists and resident text, are drawn
+// with their content at the end of the frame. A frame with Graphics3D draws is redrawn as a whole,
+// other direct OpenGL draws are not seen and have to be invalidated.
+void SetRedrawMode(RedrawMode mode);
+
+// Redraw a rectangle (x, y, width, height) in window pixels, from the bottom left, at the end of the frame
+void InvalidateRegion(Ivec4 rect);
+void InvalidateWindow();
+
+// Number of OpenGL state changes sent to the driver and filtered out as redundant
+struct StateChangeStatistics
+{
+	std::uint64_t issued, skipped;
+};
+
+// Get the state change statistics of the last completed frame
+StateChangeStatistics GetStateChangeStatistics();
+
 }
\ No newline at end of file
@@ -1,3 +1,9 @@
 #pragma once
 
-#include "./Maya/2D/graphics.hpp"
\ No newline at end of file
+#include "./Maya/2D/graphics.hpp"
+#include "./Maya/2D/sprite_batch.hpp"
+#include "./Maya/2D/command_list.hpp"
+#include "./Maya/2D/tilemap.hpp"
+#include "./Maya/2D/particles.hpp"
+#include "./Maya/2D/user_interface.hpp"
+#include "./Maya/2D/path.hpp"
\ No newline at end of file
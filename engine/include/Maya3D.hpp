@@ -1,3 +1,6 @@
 #pragma once
 
-#include "./Maya/3D/graphics.hpp"
\ No newline at end of file
+#include "./Maya/3D/graphics.hpp"
+#include "./Maya/3D/mesh.hpp"
+#include "./Maya/3D/bvh.hpp"
+#include "./Maya/3D/camera.hpp"
\ No newline at end of file
@@ -3,25 +3,77 @@
 out vec4 FragColor;
 
 in vec2 v_texture_coordinate;
-
-uniform bool u_draw_texture;
-uniform bool u_draw_text;
-uniform bool u_draw_glow;
+in vec4 v_color;
+in vec4 v_local; // xy: position inside the quad from -1 to 1, zw: half size of the quad
+// x: fill (0 color, 1 texture, 2 texture multiplied by color, 3 distance field text)
+// y: glow direction, z: shape, w: shape parameter
+flat in vec4 v_mode;
 
 uniform sampler2D u_texture;
-uniform sampler2D u_glow_texture;
-uniform vec4 u_color;
+
+// Convert an implicit function to a signed distance in pixels
+float pixels(float f)
+{
+	return f / max(length(vec2(dFdx(f), dFdy(f))), 0.0001f);
+}
+
+// Opacity falloff of the glow directions, listed in Graphics2D::GlowDirection
+float glow()
+{
+	vec2 t = v_local.xy * 0.5f + 0.5f;
+	int dir = int(v_mode.y + 0.5f);
+	float f;
+	if (dir == 0) return 1.0f;
+	else if (dir == 1) f = 1.0f - t.x; // horizontal
+	else if (dir == 2) f = t.y; // vertical
+	else if (dir == 3) f = (1.0f - t.x + t.y) * 0.5f; // diagonal
+	else if (dir == 4) f = 1.0f - length(vec2(t.x, 1.0f - t.y)); // quarter circle
+	else if (dir == 5) f = length(vec2(t.x, 1.0f - t.y)); // quarter circle exclusive
+	else if (dir == 6) f = 1.0f - length(v_local.xy); // center
+	else f = length(v_local.xy); // center exclusive
+	return clamp(f, 0.0f, 1.0f);
+}
+
+// Anti-aliased coverage of the shape: 0 rectangle, 1 oval, 2 ring, 3 rounded rectangle
+float coverage()
+{
+	vec2 p = v_local.xy, half_size = v_local.zw;
+	if (v_mode.z < 0.5f) return 1.0f;
+
+	float dist;
+	if (v_mode.z < 1.5f)
+		dist = pixels(dot(p, p) - 1.0f);
+	else if (v_mode.z < 2.5f)
+	{
+		vec2 q = p * half_size / max(half_size - v_mode.w, vec2(0.0001f));
+		dist = max(pixels(dot(p, p) - 1.0f), pixels(1.0f - dot(q, q)));
+	}
+	else
+	{
+		float r = min(v_mode.w, min(half_size.x, half_size.y));
+		vec2 q = abs(p * half_size) - half_size + r;
+		dist = pixels(length(max(q, 0.0f)) + min(max(q.x, q.y), 0.0f) - r);
+	}
+	return clamp(0.5f - dist, 0.0f, 1.0f);
+}
 
 void main()
 {
-	float glow = u_draw_glow ? texture(u_glow_texture, v_texture_coordinate).r : 1.0f;
+	float alpha = glow() * coverage();
 
-	if (u_draw_text)
+	if (v_mode.x > 2.5f)
+	{
+		float dist = texture(u_texture, v_texture_coordinate).r;
+		float edge = max(fwidth(dist) * 0.5f, 0.0001f);
+		FragColor = vec4(v_color.rgb, v_color.a * smoothstep(0.5f - edge, 0.5f + edge, dist) * alpha);
+		return;
+	}
+	if (v_mode.x > 1.5f)
 	{
-		FragColor = texture(u_texture, v_texture_coordinate) * u_color;
-		FragColor.a *= glow;
+		FragColor = texture(u_texture, v_texture_coordinate) * v_color;
+		FragColor.a *= alpha;
 		return;
 	}
-	FragColor = u_draw_texture ? texture(u_texture, v_texture_coordinate) : u_color;
-	FragColor.a *= glow;
-}
\ No newline at end of file
+	FragColor = v_mode.x > 0.5f ? texture(u_texture, v_texture_coordinate) : v_color;
+	FragColor.a *= alpha;
+}
@@ -1,15 +1,80 @@
 #version 330 core
 
+// vertex stream / vertex buffer attributes
 layout (location = 0) in vec2 in_position;
 layout (location = 1) in vec2 in_texture_coordinate;
+layout (location = 2) in vec4 in_color;
+layout (location = 3) in vec4 in_local;
+layout (location = 4) in vec4 in_mode;
+
+// per instance attributes of sprites
+layout (location = 5) in vec2 in_sprite_position;
+layout (location = 6) in vec2 in_sprite_scale;
+layout (location = 7) in float in_sprite_rotation;
+layout (location = 8) in vec4 in_sprite_color;
+layout (location = 9) in vec4 in_sprite_rect;
 
 out vec2 v_texture_coordinate;
+out vec4 v_color;
+out vec4 v_local;
+flat out vec4 v_mode;
+
+uniform mat4 u_view; // projection * camera zoom * camera position
+uniform mat4 u_model;
 
-uniform mat4 u_projection, u_view_pos, u_view_scale, u_model;
+// 0: vertex buffer of position and texture coordinate, transformed by u_model
+// 1: vertex stream, already in world space and carries its own state
+// 2: unit square instanced once per sprite
+// 3: recorded vertex stream, transformed by u_model and tinted by u_color
+uniform int u_source;
+uniform int u_fill;
+uniform int u_glow;
+uniform vec4 u_color;
 
 void main()
 {
+	if (u_source == 1)
+	{
+		v_texture_coordinate = in_texture_coordinate;
+		v_color = in_color;
+		v_local = in_local;
+		v_mode = in_mode;
+		gl_Position = u_view * vec4(in_position, 0.0f, 1.0f);
+		return;
+	}
+
+	if (u_source == 3)
+	{
+		v_texture_coordinate = in_texture_coordinate;
+		v_color = in_color * u_color;
+		v_local = in_local;
+		v_mode = in_mode;
+		// texture only fills ignore the vertex color, replay them multiplied by the tint alone
+		if (in_mode.x > 0.5f && in_mode.x < 1.5f)
+		{
+			v_color = u_color;
+			v_mode.x = 2.0f;
+		}
+		gl_Position = u_view * u_model * vec4(in_position, 0.0f, 1.0f);
+		return;
+	}
+
+	if (u_source == 2)
+	{
+		float c = cos(in_sprite_rotation), s = sin(in_sprite_rotation);
+		vec2 p = in_position * in_sprite_scale;
+		p = vec2(c * p.x + s * p.y, -s * p.x + c * p.y) + in_sprite_position;
+		v_texture_coordinate = mix(in_sprite_rect.xy, in_sprite_rect.zw, in_texture_coordinate);
+		v_color = in_sprite_color;
+		v_local = vec4(in_position * 2.0f, in_sprite_scale * 0.5f);
+		v_mode = vec4(u_fill, 0.0f, 0.0f, 0.0f);
+		gl_Position = u_view * vec4(p, 0.0f, 1.0f);
+		return;
+	}
+
 	v_texture_coordinate = in_texture_coordinate;
-	mat4 view = u_view_scale * u_view_pos;
-	gl_Position = u_projection * view * u_model * vec4(in_position, 0.0f, 1.0f);
-}
\ No newline at end of file
+	v_color = u_color;
+	v_local = vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	v_mode = vec4(u_fill, u_glow, 0.0f, 0.0f);
+	gl_Position = u_view * u_model * vec4(in_position, 0.0f, 1.0f);
+}
@@ -6,9 +6,14 @@ layout (location = 2) in vec2 in_texture_coordinate;
 
 out vec2 v_texture_coordinate;
 
-uniform mat4 u_projection, u_view, u_model;
+layout (std140, row_major) uniform Maya_Camera {
+	mat4 u_projection, u_view, u_view_projection;
+	vec4 u_camera_position;
+};
+
+uniform mat4 u_model;
 
 void main() {
 	v_texture_coordinate = in_texture_coordinate;
-	gl_Position = u_projection * u_view * u_model * vec4(in_position, 1.0f);
+	gl_Position = u_view_projection * u_model * vec4(in_position, 1.0f);
 }
\ No newline at end of file
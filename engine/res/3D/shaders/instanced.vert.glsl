@@ -0,0 +1,19 @@
+#version 330 core
+
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec3 in_normal;
+layout (location = 2) in vec2 in_texture_coordinate;
+layout (location = 3) in mat4 in_model;
+
+out vec2 v_texture_coordinate;
+
+layout (std140, row_major) uniform Maya_Camera {
+	mat4 u_projection, u_view, u_view_projection;
+	vec4 u_camera_position;
+};
+
+void main() {
+	v_texture_coordinate = in_texture_coordinate;
+	// matrices are streamed row by row, so in_model holds the transpose of the model matrix
+	gl_Position = u_view_projection * (vec4(in_position, 1.0f) * in_model);
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "../private_control.hpp"
+#include <Maya2D.hpp>
+
+namespace Maya {
+
+// Floats per vertex, same layout as the vertex stream of Graphics2D
+constexpr static int command_stride = 16;
+
+// Vertex arrays released by command lists, indexed by their capacity
+static std::unordered_map<int, std::vector<VertexArray*>> command_vaos;
+
+CommandList2D::CommandList2D()
+	: vao(nullptr), capacity(0), recorder(nullptr), valid(false), bounds(0.0f), hash(0)
+{
+}
+
+CommandList2D::~CommandList2D()
+{
+	if (recorder) End();
+	if (vao) command_vaos[capacity].push_back(vao);
+}
+
+void CommandList2D::Begin(Graphics2D& g)
+{
+	g.Flush();
+	vertices.clear();
+	segments.clear();
+	recorder = &g;
+	g.recording = this;
+}
+
+void CommandList2D::End()
+{
+#if MAYA_DEBUG
+	if (!recorder) {
+		std::cout << "CommandList2D::End is called without CommandList2D::Begin\n";
+		throw 0;
+	}
+#endif
+	recorder->recording = nullptr;
+	recorder = nullptr;
+	valid = true;
+
+	int count = int(vertices.size() / command_stride);
+	if (!count) return;
+
+	bounds = Fvec4(vertices[0], vertices[1], vertices[0], vertices[1]);
+	for (std::size_t i = 0; i < vertices.size(); i += command_stride)
+		bounds = Fvec4(std::min(bounds[0], vertices[i]), std::min(bounds[1], vertices[i + 1]),
+			std::max(bounds[2], vertices[i]), std::max(bounds[3], vertices[i + 1]));
+	hash = HashBytes(vertices.data(), vertices.size() * sizeof(float));
+	for (Segment const& segment : segments)
+		hash = HashBytes(&segment, sizeof(segment), hash);
+	if (count > capacity)
+	{
+		if (vao) command_vaos[capacity].push_back(vao);
+		capacity = 256;
+		while (capacity < count) capacity *= 2;
+
+		auto& pool = command_vaos[capacity];
+		if (!pool.empty()) {
+			vao = pool.back();
+			pool.pop_back();
+		} else {
+			VertexDataStruct vds = { { nullptr, VertexLayout(2, 2, 4, 4, 4) } };
+			vao = new VertexArray(vds, capacity);
+		}
+	}
+	vao->UpdateVBO(0, vertices.data(), count);
+}
+
+void CommandList2D::Invalidate()
+{
+	valid = false;
+}
+
+bool CommandList2D::IsValid() const
+{
+	return valid;
+}
+
+void CommandList2D::Draw(Graphics2D& g, Fmat4 const& transform, Fvec4 const& tint)
+{
+	if (!valid || segments.empty()) return;
+	if (PrivateControl::Instance().damage.Tracking())
+	{
+		Fvec4 box(1e9f, 1e9f, -1e9f, -1e9f);
+		for (int i = 0; i < 4; i++) {
+			Fvec4 p = transform * Fvec4(bounds[i % 2 ? 2 : 0], bounds[i / 2 ? 3 : 1], 0.0f, 1.0f);
+			box = Fvec4(std::min(box[0], p[0]), std::min(box[1], p[1]), std::max(box[2], p[0]), std::max(box[3], p[1]));
+		}
+		std::uint64_t h = HashBytes(&transform[0], sizeof(float) * 16, hash);
+		g.ReportExternalDraw(box, HashBytes(&tint[0], sizeof(float) * 4, h));
+	}
+	for (Segment const& segment : segments)
+	{
+		bool front = &segment == &segments.front();
+		g.ExternalDraw(3, segment.texture, 0, [vao = vao, segment, front, transform, tint](Shader& shader) {
+			if (front) {
+				Graphics2D::SendExternalColor(tint);
+				shader.SetUniform("u_model", transform);
+			}
+			vao->Draw(segment.first, segment.count);
+		});
+	}
+}
+
+float* CommandList2D::Allocate(int count, Texture* texture)
+{
+	int first = int(vertices.size() / command_stride);
+	if (segments.empty() || (texture && segments.back().texture && segments.back().texture != texture))
+		segments.push_back({ texture, first, 0 });
+	if (texture) segments.back().texture = texture;
+	segments.back().count += count;
+
+	vertices.resize(vertices.size() + std::size_t(count) * command_stride);
+	return vertices.data() + std::size_t(first) * command_stride;
+}
+
+}
@@ -12,42 +12,672 @@ constexpr static float square_vertices[] = {
 	0.5f, 0.5f, 1, 1
 };
 
+// Batched vertex: position (2), texture coordinate (2), color (4), local (4), mode (4)
+// local: position inside the quad from -1 to 1 (2), half size of the quad (2)
+// mode: fill (0 color, 1 texture, 2 texture multiplied by color, 3 distance field text), glow direction, shape, shape parameter
+constexpr static int batch_stride = 16;
+constexpr static int batch_capacity = 6 * 8192;
+
+// Largest distance in pixels between a path curve and its flattened polyline
+constexpr static float path_tolerance = 0.25f;
+
+// Size of the framebuffer being drawn into, either the window or a RenderTarget
+static Fvec2 target_size()
+{
+	Ivec4 viewport = PrivateControl::Instance().gl.GetViewport();
+	return Fvec2(float(viewport[2]), float(viewport[3]));
+}
+
+// Pixel rectangle (min x, min y, max x, max y) covered by world points seen through a view, cut by the clip
+static Fvec4 pixel_bounds(Fmat4 const& view, Ivec4 const& clip, Fvec2 const* points, int count)
+{
+	Fvec2 size = target_size();
+	Fvec4 r(1e9f, 1e9f, -1e9f, -1e9f);
+	for (int i = 0; i < count; i++) {
+		Fvec4 p = view * Fvec4(points[i][0], points[i][1], 0.0f, 1.0f);
+		float x = (p[0] * 0.5f + 0.5f) * size[0], y = (p[1] * 0.5f + 0.5f) * size[1];
+		r = Fvec4(std::min(r[0], x), std::min(r[1], y), std::max(r[2], x), std::max(r[3], y));
+	}
+	if (clip[2] >= 0) {
+		r = Fvec4(std::max(r[0], float(clip[0])), std::max(r[1], float(clip[1])),
+			std::min(r[2], float(clip[0] + clip[2])), std::min(r[3], float(clip[1] + clip[3])));
+		if (r[2] < r[0] || r[3] < r[1]) return Fvec4(-1.0f);
+	}
+	return r;
+}
+
+// Hash of the state a draw depends on besides its own content
+static std::uint64_t state_hash(Texture* texture, Fmat4 const& view, Ivec4 const& clip, std::uint64_t seed)
+{
+	std::uint64_t h = HashBytes(&texture, sizeof(texture), seed);
+	h = HashBytes(&view[0], sizeof(float) * 16, h);
+	return HashBytes(&clip[0], sizeof(int) * 4, h);
+}
+
+// Shared vertex stream of every Graphics2D, along with shadow copies of the state sent to OpenGL
+static struct Graphics2D_Batch
+{
+	Shader* shader = nullptr;
+	VertexArray* vao = nullptr;
+	std::vector<float> vertices;
+	int count = 0;
+
+	// state of the pending vertices
+	Texture* texture = nullptr;
+	std::uint64_t view_id = 0;
+	Fmat4 view;
+	Ivec4 clip = Ivec4(-1);
+
+	// uniforms last sent to the shader, the rest of the OpenGL state is tracked by PrivateControl
+	int sent_source = -1;
+	std::uint64_t sent_view_id = 0, next_view_id = 0;
+	Fvec4 sent_color = Fvec4(-1.0f);
+	int sent_glow = -1, sent_fill = -1;
+
+	std::uint64_t frame = 0;
+	Graphics2D::FrameStatistics current = {}, last = {};
+
+	// Statistics of the current frame, rolls over when a new frame begins
+	Graphics2D::FrameStatistics& Stats()
+	{
+		auto now = PrivateControl::Instance().frame;
+		if (now != frame) {
+			last = now == frame + 1 ? current : Graphics2D::FrameStatistics{};
+			current = {};
+			frame = now;
+		}
+		return current;
+	}
+
+	void BindTexture(Texture* tex)
+	{
+		if (tex) tex->Bind(0);
+	}
+
+	// Where the vertex shader takes its input from, see default.vert.glsl
+	void SetSource(int source)
+	{
+		if (sent_source == source) return;
+		shader->SetUniform("u_source", source);
+		sent_source = source;
+	}
+
+	void SendView(std::uint64_t id, Fmat4 const& mat)
+	{
+		if (sent_view_id == id) return;
+		shader->SetUniform("u_view", mat);
+		sent_view_id = id;
+	}
+
+	// Scissor rectangle in window pixels (x, y, width, height), disabled if the width is negative
+	void SendClip(Ivec4 const& rect)
+	{
+		auto& gl = PrivateControl::Instance().gl;
+		gl.SetScissorTest(rect[2] >= 0);
+		if (rect[2] >= 0) gl.SetScissor(rect);
+	}
+
+	// Uniforms of draws that are not submitted through the vertex stream
+	void SendFill(int fill)
+	{
+		if (sent_fill != fill) shader->SetUniform("u_fill", sent_fill = fill);
+	}
+
+	void SendColor(Fvec4 const& color, int glow)
+	{
+		if (!(sent_color == color)) shader->SetUniform("u_color", sent_color = color);
+		if (sent_glow != glow) shader->SetUniform("u_glow", sent_glow = glow);
+	}
+
+	void Flush()
+	{
+		if (!count) return;
+		auto& damage = PrivateControl::Instance().damage;
+		if (damage.Tracking()) ReportDamage();
+		if (damage.Deferring()) {
+			// the stream is refilled before the deferred draw runs, so it keeps a copy
+			std::vector<float> copy(vertices.begin(), vertices.begin() + std::size_t(count) * batch_stride);
+			damage.Defer([this, copy = std::move(copy), n = count, tex = texture, id = view_id, mat = view, rect = clip] {
+				Submit(copy.data(), n, tex, id, mat, rect);
+			});
+		}
+		else Submit(vertices.data(), count, texture, view_id, view, clip);
+
+		auto& stats = Stats();
+		stats.flushes++;
+		stats.draw_calls++;
+		stats.vertices += count;
+		count = 0;
+		texture = nullptr;
+	}
+
+	void Submit(float const* data, int n, Texture* tex, std::uint64_t id, Fmat4 const& mat, Ivec4 const& rect)
+	{
+		BindTexture(tex);
+		SetSource(1);
+		SendView(id, mat);
+		SendClip(rect);
+		shader->Bind();
+		vao->Draw(vao->StreamVBO(0, data, n), n);
+	}
+
+	// Every triangle damages the tiles under its bounding box
+	void ReportDamage()
+	{
+		auto& damage = PrivateControl::Instance().damage;
+		std::uint64_t state = state_hash(texture, view, clip, hash_seed);
+		for (int i = 0; i + 3 <= count; i += 3) {
+			float const* v = &vertices[i * batch_stride];
+			Fvec2 const points[3] = { Fvec2(v[0], v[1]), Fvec2(v[batch_stride], v[batch_stride + 1]),
+				Fvec2(v[batch_stride * 2], v[batch_stride * 2 + 1]) };
+			damage.Report(pixel_bounds(view, clip, points, 3), HashBytes(v, sizeof(float) * batch_stride * 3, state));
+		}
+	}
+
+	// Get room for vertices drawn with a texture, a view and a clip, flushes if they cannot join the pending ones
+	float* Reserve(int n, Texture* tex, std::uint64_t id, Fmat4 const& mat, Ivec4 const& rect)
+	{
+		bool compatible = view_id == id && clip == rect && (!tex || !texture || texture == tex);
+		if (!compatible || count + n > batch_capacity)
+			Flush();
+
+		if (!count) {
+			view_id = id;
+			view = mat;
+			clip = rect;
+		}
+		if (tex) texture = tex;
+		float* out = &vertices[count * batch_stride];
+		count += n;
+		return out;
+	}
+} batch;
+
+// Deferred submissions of every Graphics2D, sorted by their key before entering the vertex stream
+static struct Graphics2D_Queue
+{
+	// key: layer (16 bits), view and clip (8 bits), texture (16 bits), depth (24 bits)
+	// with keep order: layer (16 bits), call order (24 bits)
+	struct Entry { std::uint64_t key; Texture* texture; int view, first, count; };
+	struct View { std::uint64_t id; Fmat4 matrix; Ivec4 clip; };
+
+	std::vector<Entry> entries;
+	std::vector<std::uint32_t> order, scratch;
+	std::vector<float> vertices;
+	std::vector<View> views;
+	std::unordered_map<Texture*, std::uint64_t> texture_slots;
+
+	// Append a submission, the key is completed with the view and texture slot
+	float* Push(std::uint64_t layer, std::uint64_t low, bool keep_order, int count, Texture* texture,
+		std::uint64_t view_id, Fmat4 const& view, Ivec4 const& clip)
+	{
+		if (entries.size() >= 0xFFFFFF || views.size() >= 0xFF || texture_slots.size() >= 0xFFFF)
+			Submit();
+
+		int view_slot = int(views.size()) - 1;
+		while (view_slot >= 0 && !(views[view_slot].id == view_id && views[view_slot].clip == clip)) view_slot--;
+		if (view_slot < 0) {
+			view_slot = int(views.size());
+			views.push_back({ view_id, view, clip });
+		}
+
+		// the call order takes the view, clip and texture bits so that it is never reordered by view
+		std::uint64_t key = layer << 48 | std::uint64_t(entries.size()) << 24;
+		if (!keep_order) {
+			std::uint64_t texture_slot = texture ? texture_slots.emplace(texture, texture_slots.size() + 1).first->second : 0;
+			key = layer << 48 | std::uint64_t(view_slot) << 40 | texture_slot << 24 | low;
+		}
+
+		int first = int(vertices.size() / batch_stride);
+		entries.push_back({ key, texture, view_slot, first, count });
+		vertices.resize(vertices.size() + std::size_t(count) * batch_stride);
+		return vertices.data() + std::size_t(first) * batch_stride;
+	}
+
+	// Stable least significant digit radix sort of the entry indices, skipping bytes that never differ
+	void Sort()
+	{
+		std::uint32_t n = std::uint32_t(entries.size());
+		order.resize(n);
+		scratch.resize(n);
+		for (std::uint32_t i = 0; i < n; i++) order[i] = i;
+
+		for (int shift = 0; shift < 64; shift += 8)
+		{
+			std::uint32_t offsets[256] = {};
+			for (Entry const& e : entries) offsets[(e.key >> shift) & 0xFF]++;
+			if (offsets[(entries[0].key >> shift) & 0xFF] == n) continue;
+
+			for (std::uint32_t i = 0, sum = 0; i < 256; i++) {
+				std::uint32_t c = offsets[i];
+				offsets[i] = sum;
+				sum += c;
+			}
+			for (std::uint32_t i : order)
+				scratch[offsets[(entries[i].key >> shift) & 0xFF]++] = i;
+			order.swap(scratch);
+		}
+	}
+
+	// Move every queued submission into the vertex stream in sorted order
+	void Submit()
+	{
+		if (entries.empty()) return;
+		Sort();
+
+		auto changes = [](Texture*& last, Texture* texture) {
+			bool changed = texture && last && texture != last;
+			if (texture) last = texture;
+			return changed ? 1u : 0u;
+		};
+		unsigned int before = 0, after = 0;
+		Texture* last = nullptr;
+		for (Entry const& e : entries) before += changes(last, e.texture);
+		last = nullptr;
+
+		for (std::uint32_t i : order)
+		{
+			Entry const& e = entries[i];
+			after += changes(last, e.texture);
+			View const& view = views[e.view];
+			float* out = batch.Reserve(e.count, e.texture, view.id, view.matrix, view.clip);
+			std::copy_n(vertices.data() + std::size_t(e.first) * batch_stride, std::size_t(e.count) * batch_stride, out);
+		}
+
+		auto& stats = batch.Stats();
+		stats.sorted += unsigned(entries.size());
+		stats.texture_changes_saved += before > after ? before - after : 0;
+		entries.clear();
+		vertices.clear();
+		views.clear();
+		texture_slots.clear();
+	}
+} queue;
+
+// Submit the deferred queue and the vertex stream
+static void flush_all()
+{
+	queue.Submit();
+	batch.Flush();
+}
+
+// Rotate a local position clockwise with precomputed cos and sin
+static inline Fvec2 rotate_point(float x, float y, float c, float s)
+{
+	return Fvec2(c * x + s * y, -s * x + c * y);
+}
+
+// Corners of the two triangles of a quad, as indices of bottom left, top left, bottom right, top right
+constexpr static int quad_indices[6] = { 0, 1, 2, 1, 2, 3 };
+constexpr static float quad_corners[4][2] = { { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 } };
+
+static inline void write_vertex(float*& out, Fvec2 pos, float u, float v, Fvec4 const& color,
+	float const (&corner)[2], Fvec2 half_size, Fvec4 const& mode)
+{
+	out[0] = pos[0]; out[1] = pos[1];
+	out[2] = u; out[3] = v;
+	out[4] = color[0]; out[5] = color[1]; out[6] = color[2]; out[7] = color[3];
+	out[8] = corner[0]; out[9] = corner[1]; out[10] = half_size[0]; out[11] = half_size[1];
+	out[12] = mode[0]; out[13] = mode[1]; out[14] = mode[2]; out[15] = mode[3];
+	out += batch_stride;
+}
+
+// Write two triangles from corners ordered bottom left, top left, bottom right, top right
+static inline void write_quad(float*& out, Fvec2 const (&p)[4], Fvec2 uv0, Fvec2 uv1, Fvec4 const& color,
+	Fvec2 half_size, Fvec4 const& mode)
+{
+	for (int i : quad_indices)
+		write_vertex(out, p[i], i < 2 ? uv0[0] : uv1[0], i % 2 ? uv1[1] : uv0[1], color, quad_corners[i], half_size, mode);
+}
+
+// Triangles of a stroked path, 6 floats per vertex: position (2), texture coordinate (2), local (2)
+static struct Graphics2D_Stroke
+{
+	static constexpr float miter_limit = 4.0f; // longest miter allowed, relative to half the line width
+
+	std::vector<float> vertices;
+	std::vector<float> xs, ys, dx, dy, length; // per point and per segment, kept apart so the loops vectorize
+
+	void Vertex(float x, float y, float u, float v)
+	{
+		vertices.insert(vertices.end(), { x, y, u, v, u * 2.0f - 1.0f, v * 2.0f - 1.0f });
+	}
+
+	// Fill the gap on the outer side of the corner at point i, between segments a and b
+	void Join(int i, int a, int b, float hw, float u, Graphics2D::LineJoin join)
+	{
+		float x = xs[i], y = ys[i];
+		float cross = dx[a] * dy[b] - dy[a] * dx[b];
+		float dot = dx[a] * dx[b] + dy[a] * dy[b];
+		if (std::abs(cross) < 1e-6f && dot > 0.0f) return;
+
+		// normals of both segments pointing to the outer side
+		float side = cross > 0.0f ? -1.0f : 1.0f;
+		float n0x = -dy[a] * side * hw, n0y = dx[a] * side * hw;
+		float n1x = -dy[b] * side * hw, n1y = dx[b] * side * hw;
+		float v = side > 0.0f ? 1.0f : 0.0f;
+
+		if (join == Graphics2D::JoinMiter)
+		{
+			// the miter tip lies along the bisector of the normals, at hw / cos(half angle)
+			float mx = n0x + n1x, my = n0y + n1y;
+			float proj = (mx * n0x + my * n0y) / hw;
+			if (proj > 0.0f && mx * mx + my * my <= miter_limit * miter_limit * proj * proj) {
+				float k = hw / proj;
+				Vertex(x, y, u, 0.5f); Vertex(x + n0x, y + n0y, u, v); Vertex(x + mx * k, y + my * k, u, v);
+				Vertex(x, y, u, 0.5f); Vertex(x + mx * k, y + my * k, u, v); Vertex(x + n1x, y + n1y, u, v);
+				return;
+			}
+		}
+		else if (join == Graphics2D::JoinRound)
+		{
+			// enough steps to keep the arc within a quarter pixel of a true circle
+			float angle = std::atan2(std::abs(cross), dot);
+			float step = 2.0f * std::acos(std::max(1.0f - 0.25f / std::max(hw, 0.25f), -1.0f));
+			int steps = std::clamp(int(std::ceil(angle / std::max(step, 0.01f))), 1, 64);
+			float theta = (cross > 0.0f ? angle : -angle) / steps;
+			float c = std::cos(theta), sn = std::sin(theta);
+			float px = n0x, py = n0y;
+			for (int k = 0; k < steps; k++) {
+				float qx = c * px - sn * py, qy = sn * px + c * py;
+				if (k == steps - 1) qx = n1x, qy = n1y;
+				Vertex(x, y, u, 0.5f); Vertex(x + px, y + py, u, v); Vertex(x + qx, y + qy, u, v);
+				px = qx, py = qy;
+			}
+			return;
+		}
+
+		Vertex(x, y, u, 0.5f); Vertex(x + n0x, y + n0y, u, v); Vertex(x + n1x, y + n1y, u, v);
+	}
+
+	// Build the triangles of a path, returns the number of vertices
+	int Build(std::span<Fvec2 const> points, bool closed, float hw, Graphics2D::LineJoin join)
+	{
+		vertices.clear();
+		xs.clear(); ys.clear();
+		for (Fvec2 const& p : points) {
+			if (!xs.empty() && xs.back() == p[0] && ys.back() == p[1]) continue;
+			xs.push_back(p[0]); ys.push_back(p[1]);
+		}
+		if (closed && xs.size() > 1 && xs.front() == xs.back() && ys.front() == ys.back()) {
+			xs.pop_back(); ys.pop_back();
+		}
+
+		int n = int(xs.size());
+		int segments = closed ? n : n - 1;
+		if (n < 2) return 0;
+
+		dx.resize(segments); dy.resize(segments); length.resize(segments);
+		for (int i = 0; i < n - 1; i++) {
+			dx[i] = xs[i + 1] - xs[i];
+			dy[i] = ys[i + 1] - ys[i];
+		}
+		if (closed) {
+			dx[n - 1] = xs[0] - xs[n - 1];
+			dy[n - 1] = ys[0] - ys[n - 1];
+		}
+		for (int i = 0; i < segments; i++)
+			length[i] = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+		for (int i = 0; i < segments; i++) {
+			dx[i] /= length[i];
+			dy[i] /= length[i];
+		}
+
+		float total = 0.0f;
+		for (int i = 0; i < segments; i++) total += length[i];
+
+		vertices.reserve(std::size_t(segments) * 6 * 6 * (join == Graphics2D::JoinRound ? 4 : 2));
+		float distance = 0.0f;
+		for (int i = 0; i < segments; i++)
+		{
+			int j = (i + 1) % n;
+			float nx = -dy[i] * hw, ny = dx[i] * hw;
+			float u0 = distance / total, u1 = (distance + length[i]) / total;
+			Vertex(xs[i] - nx, ys[i] - ny, u0, 0.0f); Vertex(xs[i] + nx, ys[i] + ny, u0, 1.0f); Vertex(xs[j] - nx, ys[j] - ny, u1, 0.0f);
+			Vertex(xs[i] + nx, ys[i] + ny, u0, 1.0f); Vertex(xs[j] - nx, ys[j] - ny, u1, 0.0f); Vertex(xs[j] + nx, ys[j] + ny, u1, 1.0f);
+			distance += length[i];
+
+			if (i + 1 < segments) Join(j, i, i + 1, hw, u1, join);
+			else if (closed) Join(0, i, 0, hw, 0.0f, join);
+		}
+		return int(vertices.size() / 6);
+	}
+} stroke;
+
+// String hashing that allows lookups with std::string_view
+struct Graphics2D_StringHash
+{
+	using is_transparent = void;
+	std::size_t operator()(std::string_view str) const { return std::hash<std::string_view>()(str); }
+};
+
+// A laid out string in local space, 6 vertices of position and texture coordinate per glyph
+struct Graphics2D_TextRun
+{
+	std::vector<float> vertices;
+	Texture* atlas;
+	Fvec4 bounds; // min x, min y, max x, max y of the vertices
+	VertexArray* vao = nullptr;
+	int capacity = 0;
+	std::uint64_t last_used = 0;
+};
+
+using Graphics2D_TextRuns = std::unordered_map<std::string, Graphics2D_TextRun, Graphics2D_StringHash, std::equal_to<>>;
+
+// Cached text runs keyed by font, alignment and string, along with the vertex arrays of evicted GPU runs
+static struct Graphics2D_TextCache
+{
+	std::unordered_map<Font*, std::array<Graphics2D_TextRuns, 3>> fonts;
+	std::unordered_map<int, std::vector<VertexArray*>> free_vaos;
+	std::vector<float> scratch;
+	unsigned int lifetime = 120;
+	std::uint64_t swept = 0;
+
+	// Evict runs that have not been drawn within the lifetime, runs once every few frames
+	void Sweep()
+	{
+		auto now = PrivateControl::Instance().frame;
+		if (now < swept + 30) return;
+		swept = now;
+
+		for (auto& [font, aligns] : fonts)
+			for (auto& runs : aligns)
+				std::erase_if(runs, [&](auto& pair) {
+					auto& run = pair.second;
+					if (run.last_used + lifetime >= now) return false;
+					if (run.vao) free_vaos[run.capacity].push_back(run.vao);
+					return true;
+				});
+	}
+
+	// Upload the run into a vertex array, reusing one of an evicted run if possible
+	void MakeResident(Graphics2D_TextRun& run)
+	{
+		int glyphs = int(run.vertices.size() / 24);
+		run.capacity = 16;
+		while (run.capacity < glyphs) run.capacity *= 2;
+
+		auto& pool = free_vaos[run.capacity];
+		if (!pool.empty()) {
+			run.vao = pool.back();
+			pool.pop_back();
+		} else {
+			VertexDataStruct vds = { { nullptr, VertexLayout(2, 2) } };
+			run.vao = new VertexArray(vds, run.capacity * 6);
+		}
+		run.vao->UpdateVBO(0, run.vertices.data(), glyphs * 6);
+	}
+} text_runs;
+
+// Bounding box of laid out glyph vertices: min x, min y, max x, max y
+static Fvec4 text_bounds(std::vector<float> const& vertices)
+{
+	if (vertices.empty()) return Fvec4(0.0f);
+	Fvec4 bounds(vertices[0], vertices[1], vertices[0], vertices[1]);
+	for (std::size_t i = 0; i < vertices.size(); i += 4) {
+		bounds[0] = std::min(bounds[0], vertices[i]);
+		bounds[1] = std::min(bounds[1], vertices[i + 1]);
+		bounds[2] = std::max(bounds[2], vertices[i]);
+		bounds[3] = std::max(bounds[3], vertices[i + 1]);
+	}
+	return bounds;
+}
+
+// Lay out a string relative to its anchor point
+static void layout_text(Font& font, std::string_view str, Graphics2D::TextAlignment align, std::vector<float>& out)
+{
+	Fvec2 text_size(0.0f);
+	for (std::size_t i = 0; i < str.size(); i++) {
+		Glyph glyph = font[str[i]];
+		text_size[0] += glyph.advance >> 6;
+		if (glyph.bearing[1] > text_size[1])
+			text_size[1] = glyph.bearing[1];
+	}
+
+	out.resize(str.size() * 24);
+	float* v = out.data();
+	float char_x = align == Graphics2D::AlignCenter ? -text_size[0] / 2.0f
+		: (align == Graphics2D::AlignRight ? -text_size[0] : 0.0f);
+
+	for (std::size_t i = 0; i < str.size(); i++)
+	{
+		Glyph glyph = font[str[i]];
+		float x0 = char_x + glyph.bearing[0], x1 = x0 + glyph.size[0];
+		float y0 = (float)(glyph.bearing[1] - glyph.size[1]) - text_size[1] / 2.0f, y1 = y0 + glyph.size[1];
+		float u0 = glyph.uv_min[0], v0 = glyph.uv_min[1], u1 = glyph.uv_max[0], v1 = glyph.uv_max[1];
+		float const quad[] = {
+			x0, y0, u0, v0,
+			x0, y1, u0, v1,
+			x1, y0, u1, v0,
+			x0, y1, u0, v1,
+			x1, y0, u1, v0,
+			x1, y1, u1, v1
+		};
+		std::copy(std::begin(quad), std::end(quad), v);
+		v += 24;
+		char_x += glyph.advance >> 6;
+	}
+}
+
 void Graphics2D::InitResources()
 {
 	Shader* shader = new Shader("engine/res/2D/shaders/default.vert.glsl", "engine/res/2D/shaders/default.frag.glsl");
 	shader->SetUniform("u_texture", 0);
-	shader->SetUniform("u_glow_texture", 1);
 
 	VertexArray* square_vao = new VertexArray(6);
 	square_vao->LinkVBO(square_vertices, VertexLayout(2, 2));
 
+	VertexDataStruct batch_vds = { { nullptr, VertexLayout(2, 2, 4, 4, 4) } };
+	batch.vao = new VertexArray(batch_vds, batch_capacity);
+	batch.vertices.resize(batch_capacity * batch_stride);
+
 	Assign("Maya_2D_shader_default", shader);
 	Assign("Maya_2D_vao_square", square_vao);
-	Assign("Maya_2D_font_Arial_30", new Font("engine/res/Arial.ttf", 30));
+	Assign("Maya_2D_vao_batch", batch.vao);
+	Font* arial = new Font("engine/res/Arial.ttf", 30, true);
+	Assign("Maya_2D_font_Arial", arial);
+	Assign("Maya_2D_font_Arial_30", arial); // name used before the font became scalable
 
-	auto assign_glow = [](std::string const& name) { Assign("Maya_2D_glow_" + name, new Texture("engine/res/2D/glows/" + name + ".jpg", 3)); };
-	assign_glow("horizontal");
-	assign_glow("vertical");
-	assign_glow("diagonal");
-	assign_glow("quarter_circle");
-	assign_glow("quarter_circle_exclusive");
-	assign_glow("center");
-	assign_glow("center_exclusive");
+	batch.shader = shader;
+	PrivateControl::Instance().frame_end_callbacks.push_back(flush_all);
+	PrivateControl::Instance().flush_callbacks.push_back(flush_all);
+}
+
+Graphics2D::FrameStatistics Graphics2D::GetFrameStatistics()
+{
+	batch.Stats();
+	return batch.last;
+}
+
+void Graphics2D::SetTextCacheLifetime(unsigned int frames)
+{
+	text_runs.lifetime = frames;
 }
 
 Graphics2D::Graphics2D()
-	: shader(GetShader("Maya_2D_shader_default")), rotation(0), oval_measure(0), line_width(1)
+	: shader(GetShader("Maya_2D_shader_default")), projection(target_size()), camera_position(0.0f), camera_zoom(1.0f),
+	  view_id(0), auto_projection(true), rotation(0), rotation_cos(1), rotation_sin(0), line_width(1), line_join(JoinMiter),
+	  text_cache(TextCacheLayout), text_size(0), texture(nullptr), sub_texture(nullptr), glow(NoGlow), batching(false), recording(nullptr),
+	  deferred(false), keep_order(false), layer(0), depth(0), culling(true),
+	  clip(-1)
 {
 	SetColor(0xFFFFFF);
-	SetTexture(nullptr);
-	SetGlowDirection(NoGlow);
-	SetOvalGood(50);
 	SetFont(nullptr);
 	SetTextAlignment(AlignLeft);
+}
+
+Graphics2D::~Graphics2D()
+{
+	Flush();
+}
+
+void Graphics2D::SetBatching(bool enable)
+{
+	if (!enable) Flush();
+	batching = enable;
+}
+
+void Graphics2D::Flush()
+{
+	flush_all();
+}
+
+void Graphics2D::SetDeferred(bool enable)
+{
+	if (!enable) Flush();
+	deferred = enable;
+}
+
+void Graphics2D::SetLayer(int layer)
+{
+	this->layer = std::clamp(layer, -32768, 32767);
+}
+
+void Graphics2D::SetDepth(float depth)
+{
+	this->depth = std::clamp(depth, 0.0f, 1.0f);
+}
+
+void Graphics2D::SetKeepOrder(bool keep)
+{
+	keep_order = keep;
+}
+
+void Graphics2D::SetCulling(bool enable)
+{
+	culling = enable;
+}
+
+void Graphics2D::SetClip(Fvec2 position, Fvec2 size)
+{
+	// the scissor box is in framebuffer pixels, so the world rectangle goes through the view
+	UpdateView();
+	Fvec2 window = target_size();
+	Fvec2 lo(1e9f), hi(-1e9f);
+	for (int i = 0; i < 4; i++) {
+		Fvec4 p = view * Fvec4(position[0] + size[0] * (i % 2 ? 0.5f : -0.5f), position[1] + size[1] * (i / 2 ? 0.5f : -0.5f), 0.0f, 1.0f);
+		Fvec2 pixel((p[0] * 0.5f + 0.5f) * window[0], (p[1] * 0.5f + 0.5f) * window[1]);
+		lo = Fvec2(std::min(lo[0], pixel[0]), std::min(lo[1], pixel[1]));
+		hi = Fvec2(std::max(hi[0], pixel[0]), std::max(hi[1], pixel[1]));
+	}
+	int x0 = int(std::floor(lo[0])), y0 = int(std::floor(lo[1]));
+	clip = Ivec4(x0, y0, std::max(int(std::ceil(hi[0])) - x0, 0), std::max(int(std::ceil(hi[1])) - y0, 0));
+}
 
-	SetProjection(GetWindowSize());
-	SetCameraPosition(0);
-	SetCameraZoom(1);
+void Graphics2D::ClearClip()
+{
+	clip = Ivec4(-1);
+}
+
+Fvec2 Graphics2D::MeasureText(std::string_view str) const
+{
+	Fvec2 size(0.0f);
+	for (char c : str) {
+		Glyph glyph = (*font)[c];
+		size[0] += glyph.advance >> 6;
+		size[1] = std::max(size[1], float(glyph.bearing[1]));
+	}
+	return size * (text_size > 0.0f ? text_size / font->GetPixelSize() : 1.0f);
 }
 
 void Graphics2D::SetProjection(Fvec2 size)
@@ -57,14 +687,21 @@ void Graphics2D::SetProjection(Fvec2 size)
 
 void Graphics2D::SetProjection(float width, float height)
 {
-	Fmat4 proj = OrthogonalProjection(-width / 2.0f, width / 2.0f, -height / 2.0f, height / 2.0f);
-	shader.SetUniform("u_projection", proj);
+	projection = Fvec2(width, height);
+	auto_projection = false;
+	view_id = 0;
+}
+
+void Graphics2D::SetProjectionToWindow()
+{
+	auto_projection = true;
+	view_id = 0;
 }
 
 void Graphics2D::SetCameraPosition(Fvec2 position)
 {
-	Fmat4 pos = Translate(-position);
-	shader.SetUniform("u_view_pos", pos);
+	camera_position = position;
+	view_id = 0;
 }
 
 void Graphics2D::SetCameraPosition(float x, float y)
@@ -74,8 +711,8 @@ void Graphics2D::SetCameraPosition(float x, float y)
 
 void Graphics2D::SetCameraZoom(Fvec2 zoom)
 {
-	Fmat4 scale = Scale(zoom);
-	shader.SetUniform("u_view_scale", scale);
+	camera_zoom = zoom;
+	view_id = 0;
 }
 
 void Graphics2D::SetCameraZoom(float x, float y)
@@ -85,12 +722,10 @@ void Graphics2D::SetCameraZoom(float x, float y)
 
 void Graphics2D::SetColor(unsigned int hex, float opacity)
 {
-	Fvec4 color;
 	color[0] = (std::uint8_t)(hex >> 16) / 255.0f;
 	color[1] = (std::uint8_t)(hex >> 8) / 255.0f;
 	color[2] = (std::uint8_t)(hex) / 255.0f;
 	color[3] = opacity;
-	shader.SetUniform("u_color", color);
 }
 
 void Graphics2D::SetTexture(std::string const& name)
@@ -100,95 +735,158 @@ void Graphics2D::SetTexture(std::string const& name)
 
 void Graphics2D::SetTexture(Texture* texture)
 {
-	if (texture) texture->Bind(0);
-	shader.SetUniform("u_draw_texture", texture ? 1 : 0);
+	this->texture = texture;
+	sub_texture = nullptr;
+}
+
+void Graphics2D::SetTexture(SubTexture const& sub_texture)
+{
+	this->texture = sub_texture.page;
+	this->sub_texture = &sub_texture;
 }
 
 void Graphics2D::SetGlowDirection(GlowDirection dir)
 {
-	std::string target;
-	switch (dir)
-	{
-		case GlowHorizontal:				target = "horizontal"; break;
-		case GlowVertical:					target = "vertical"; break;
-		case GlowDiagonal:					target = "diagonal"; break;
-		case GlowQuarterCircle:				target = "quarter_circle"; break;
-		case GlowQuarterCircleExclusive:	target = "quarter_circle_exclusive"; break;
-		case GlowCenter:					target = "center"; break;
-		case GlowCenterExclusive:			target = "center_exclusive"; break;
-		default: shader.SetUniform("u_draw_glow", 0); return;
-	}
+	glow = dir;
+}
 
-	GetTexture("Maya_2D_glow_" + target).Bind(1);
-	shader.SetUniform("u_draw_glow", 1);
+void Graphics2D::SetOvalGood(unsigned int)
+{
+	// kept for source compatibility, ovals used to be triangle fans with this many segments
 }
 
 void Graphics2D::SetRotation(float radian)
 {
 	rotation = radian;
+	rotation_cos = std::cos(radian);
+	rotation_sin = std::sin(radian);
 }
 
-void Graphics2D::SetOvalGood(unsigned int measure)
+void Graphics2D::SetLineWidth(float width)
 {
-#if MAYA_DEBUG
-	if (measure < 3) {
-		std::cout << "Attempting to call Graphics2D::SetOvalGood with measure < 3\n";
-		return;
-	}
-#endif
-	oval_measure = measure;
-	auto& ctrl = PrivateControl::Instance();
-	std::string name = "Maya_2D_vao_circle_" + std::to_string(measure);
-	if (ctrl.vaos.count(name)) return;
+	line_width = width;
+}
 
-	std::vector<float> vertices;
-	vertices.reserve(measure * 4);
+void Graphics2D::SetLineJoin(LineJoin join)
+{
+	line_join = join;
+}
 
-	for (int i = 0; i < measure; i++)
-	{
-		float rot = 2 * 3.1415926536f * i / measure;
-		float s = std::sinf(rot) * 0.5f, c = std::cosf(rot) * 0.5f;
-		vertices.push_back(c);
-		vertices.push_back(s);
-		vertices.push_back(c + 0.5f);
-		vertices.push_back(s + 0.5f);
-	}
+void Graphics2D::SetFont(std::string const& name)
+{
+	SetFont(&GetFont(name));
+}
 
-	unsigned int triangles = measure - 2;
-	std::vector<unsigned int> indices;
-	indices.reserve(triangles * 3);
+void Graphics2D::SetFont(Font* font)
+{
+	this->font = font ? font : &GetFont("Maya_2D_font_Arial");
+}
 
-	for (int i = 0; i < triangles; i++)
-	{
-		indices.push_back(0);
-		indices.push_back(i + 1);
-		indices.push_back(i + 2);
+void Graphics2D::SetTextAlignment(TextAlignment align)
+{
+	this->align = align;
+}
+
+void Graphics2D::SetTextSize(float pixels)
+{
+	text_size = pixels;
+}
+
+void Graphics2D::SetTextCache(TextCacheMode mode)
+{
+	text_cache = mode;
+}
+
+void Graphics2D::UpdateView()
+{
+	if (auto_projection) {
+		Fvec2 size = target_size();
+		if (!(size == projection)) {
+			projection = size;
+			view_id = 0;
+		}
 	}
+	if (view_id) return;
 
-	VertexArray* oval_vao = new VertexArray(measure);
-	oval_vao->LinkVBO(&vertices[0], VertexLayout(2, 2));
-	oval_vao->LinkIBO(&indices[0], indices.size());
-	Assign(name, oval_vao);
+	view = OrthogonalProjection(-projection[0] / 2.0f, projection[0] / 2.0f, -projection[1] / 2.0f, projection[1] / 2.0f)
+		* Scale(camera_zoom) * Translate(-camera_position);
+	view_id = ++batch.next_view_id;
+
+	Fvec2 half(std::abs(projection[0] / 2.0f / camera_zoom[0]), std::abs(projection[1] / 2.0f / camera_zoom[1]));
+	visible = Fvec4(camera_position[0] - half[0], camera_position[1] - half[1], camera_position[0] + half[0], camera_position[1] + half[1]);
 }
 
-void Graphics2D::SetLineWidth(float width)
+bool Graphics2D::Cull(Fvec2 center, Fvec2 extent)
 {
-	line_width = width;
+	// recorded draws are replayed under another transform, so they are never culled
+	if (!culling || recording) return false;
+	UpdateView();
+	bool outside = center[0] + extent[0] < visible[0] || center[0] - extent[0] > visible[2]
+		|| center[1] + extent[1] < visible[1] || center[1] - extent[1] > visible[3];
+	auto& stats = batch.Stats();
+	(outside ? stats.culled : stats.drawn)++;
+	return outside;
 }
 
-void Graphics2D::SetFont(std::string const& name)
+void Graphics2D::ExternalDraw(int source, Texture* texture, int fill, std::function<void(Shader&)> draw)
 {
-	SetFont(&GetFont(name));
+#if MAYA_DEBUG
+	if (recording) std::cout << "Draws that bypass the vertex stream are not recorded into CommandList2D\n";
+#endif
+	UpdateView();
+	flush_all();
+	batch.Stats().draw_calls++;
+
+	auto submit = [shader = &shader, source, texture, fill, id = view_id, mat = view, rect = clip, draw = std::move(draw)] {
+		batch.BindTexture(texture);
+		batch.SetSource(source);
+		batch.SendView(id, mat);
+		batch.SendClip(rect);
+		batch.SendFill(fill);
+		draw(*shader);
+	};
+	auto& damage = PrivateControl::Instance().damage;
+	if (damage.Deferring()) damage.Defer(std::move(submit));
+	else submit();
 }
 
-void Graphics2D::SetFont(Font* font)
+void Graphics2D::SendExternalColor(Fvec4 const& color, GlowDirection glow)
 {
-	this->font = font ? font : &GetFont("Maya_2D_font_Arial_30");
+	batch.SendColor(color, glow);
 }
 
-void Graphics2D::SetTextAlignment(TextAlignment align)
+void Graphics2D::ReportExternalDraw(Fvec4 const& bounds, std::uint64_t hash)
 {
-	this->align = align;
+	UpdateView();
+	Fvec2 const corners[4] = { Fvec2(bounds[0], bounds[1]), Fvec2(bounds[0], bounds[3]), Fvec2(bounds[2], bounds[1]), Fvec2(bounds[2], bounds[3]) };
+	PrivateControl::Instance().damage.Report(pixel_bounds(view, clip, corners, 4), state_hash(nullptr, view, clip, hash));
+}
+
+float* Graphics2D::BatchVertices(int count, Texture* texture)
+{
+	if (recording) return recording->Allocate(count, texture);
+	UpdateView();
+	if (deferred)
+		return queue.Push(std::uint64_t(layer + 32768), std::uint64_t(depth * 0xFFFFFF), keep_order, count, texture, view_id, view, clip);
+	return batch.Reserve(count, texture, view_id, view, clip);
+}
+
+void Graphics2D::DrawShape(Fvec2 position, Fvec2 scale, float shape, float param)
+{
+	Fvec2 half = scale / 2.0f;
+	float ac = std::abs(rotation_cos), as = std::abs(rotation_sin);
+	if (Cull(position, Fvec2(ac * std::abs(half[0]) + as * std::abs(half[1]), as * std::abs(half[0]) + ac * std::abs(half[1]))))
+		return;
+	Fvec2 const corners[4] = {
+		position + rotate_point(-half[0], -half[1], rotation_cos, rotation_sin),
+		position + rotate_point(-half[0], half[1], rotation_cos, rotation_sin),
+		position + rotate_point(half[0], -half[1], rotation_cos, rotation_sin),
+		position + rotate_point(half[0], half[1], rotation_cos, rotation_sin)
+	};
+	Fvec4 mode(texture ? 1.0f : 0.0f, float(glow), shape, param);
+	float* out = BatchVertices(6, texture);
+	write_quad(out, corners, sub_texture ? sub_texture->uv_min : Fvec2(0.0f), sub_texture ? sub_texture->uv_max : Fvec2(1.0f), color, half, mode);
+	if (!batching && !deferred) Flush();
 }
 
 void Graphics2D::DrawRect(float x, float y, float width, float height)
@@ -198,8 +896,7 @@ void Graphics2D::DrawRect(float x, float y, float width, float height)
 
 void Graphics2D::DrawRect(Fvec2 position, Fvec2 scale)
 {
-	shader.SetUniform("u_model", Translate(position) * Rotate(rotation) * Scale(scale));
-	shader.Draw("Maya_2D_vao_square");
+	DrawShape(position, scale, 0.0f, 0.0f);
 }
 
 void Graphics2D::DrawOval(float x, float y, float width, float height)
@@ -209,9 +906,27 @@ void Graphics2D::DrawOval(float x, float y, float width, float height)
 
 void Graphics2D::DrawOval(Fvec2 position, Fvec2 scale)
 {
-	shader.SetUniform("u_model", Translate(position) * Rotate(rotation) * Scale(scale));
-	std::string name = "Maya_2D_vao_circle_" + std::to_string(oval_measure);
-	shader.Draw(name);
+	DrawShape(position, scale, 1.0f, 0.0f);
+}
+
+void Graphics2D::DrawRing(float x, float y, float width, float height, float thickness)
+{
+	DrawRing(Fvec2(x, y), Fvec2(width, height), thickness);
+}
+
+void Graphics2D::DrawRing(Fvec2 position, Fvec2 scale, float thickness)
+{
+	DrawShape(position, scale, 2.0f, thickness);
+}
+
+void Graphics2D::DrawRoundedRect(float x, float y, float width, float height, float radius)
+{
+	DrawRoundedRect(Fvec2(x, y), Fvec2(width, height), radius);
+}
+
+void Graphics2D::DrawRoundedRect(Fvec2 position, Fvec2 scale, float radius)
+{
+	DrawShape(position, scale, 3.0f, radius);
 }
 
 void Graphics2D::DrawLine(float x1, float y1, float x2, float y2)
@@ -222,45 +937,183 @@ void Graphics2D::DrawLine(float x1, float y1, float x2, float y2)
 void Graphics2D::DrawLine(Fvec2 start, Fvec2 end)
 {
 	if (start == end) return;
-	Fmat4 pos = Translate((start + end) / 2.0f);
+	float hw = line_width / 2.0f;
+	if (Cull((start + end) / 2.0f, Fvec2(std::abs(end[0] - start[0]) / 2.0f + hw, std::abs(end[1] - start[1]) / 2.0f + hw)))
+		return;
 	Fvec2 dv = end - start;
-	Fmat4 scale = Scale(Fvec2(dv.Norm(), line_width));
-	Fmat4 rot = Rotate(std::atan2(dv[1], dv[0]));
-	shader.SetUniform("u_model", pos * rot * scale);
-	shader.Draw("Maya_2D_vao_square");
+	float length = dv.Norm();
+	Fvec2 normal = Fvec2(-dv[1], dv[0]) * (line_width / 2.0f / length);
+	Fvec2 const corners[4] = { start - normal, start + normal, end - normal, end + normal };
+	Fvec4 mode(texture ? 1.0f : 0.0f, float(glow), 0.0f, 0.0f);
+	float* out = BatchVertices(6, texture);
+	write_quad(out, corners, sub_texture ? sub_texture->uv_min : Fvec2(0.0f), sub_texture ? sub_texture->uv_max : Fvec2(1.0f),
+		color, Fvec2(length, line_width) / 2.0f, mode);
+	if (!batching && !deferred) Flush();
+}
+
+void Graphics2D::DrawPolyline(std::span<Fvec2 const> points)
+{
+	DrawStroke(points, false);
+}
+
+void Graphics2D::DrawPolygonOutline(std::span<Fvec2 const> points)
+{
+	DrawStroke(points, true);
+}
+
+void Graphics2D::DrawStroke(std::span<Fvec2 const> points, bool closed)
+{
+	if (points.empty()) return;
+	Fvec2 lo = points[0], hi = points[0];
+	for (Fvec2 const& p : points) {
+		lo = Fvec2(std::min(lo[0], p[0]), std::min(lo[1], p[1]));
+		hi = Fvec2(std::max(hi[0], p[0]), std::max(hi[1], p[1]));
+	}
+	float pad = line_width / 2.0f * (line_join == JoinMiter ? Graphics2D_Stroke::miter_limit : 1.0f);
+	if (Cull((lo + hi) / 2.0f, (hi - lo) / 2.0f + Fvec2(pad)))
+		return;
+
+	int total = stroke.Build(points, closed, line_width / 2.0f, line_join);
+	if (!total) return;
+
+	// the whole path goes into the stream, split only when it exceeds the stream capacity
+	Fvec4 mode(texture ? 1.0f : 0.0f, float(glow), 0.0f, 0.0f);
+	Fvec2 half(1.0f);
+	Fvec2 uv0 = sub_texture ? sub_texture->uv_min : Fvec2(0.0f), uv1 = sub_texture ? sub_texture->uv_max : Fvec2(1.0f);
+	float const* in = stroke.vertices.data();
+	for (int first = 0; first < total; first += batch_capacity)
+	{
+		int count = std::min(total - first, batch_capacity);
+		float* out = BatchVertices(count, texture);
+		for (int i = 0; i < count; i++, in += 6) {
+			float const local[2] = { in[4], in[5] };
+			write_vertex(out, Fvec2(in[0], in[1]), uv0[0] + (uv1[0] - uv0[0]) * in[2], uv0[1] + (uv1[1] - uv0[1]) * in[3],
+				color, local, half, mode);
+		}
+	}
+
+	if (!batching && !deferred) Flush();
+}
+
+void Graphics2D::TessellatePath(Path2D const& path)
+{
+	// tolerance in world units, snapped down to a power of two so that small zoom changes reuse the cache
+	Fvec2 window = target_size();
+	float per_pixel = std::min(std::abs(projection[0] / (window[0] * camera_zoom[0])), std::abs(projection[1] / (window[1] * camera_zoom[1])));
+	float tolerance = std::exp2(std::floor(std::log2(per_pixel * path_tolerance)));
+	if (!std::isfinite(tolerance) || tolerance <= 0.0f)
+		tolerance = path.tolerance > 0.0f ? path.tolerance : 1.0f;
+	if (path.tolerance != tolerance) path.Flatten(tolerance);
+}
+
+void Graphics2D::FillPath(Path2D const& path)
+{
+	TessellatePath(path);
+	if (!path.fill_valid) path.Triangulate();
+	if (path.fill.empty()) return;
+
+	Fvec4 const& b = path.bounds;
+	Fvec2 half((b[2] - b[0]) / 2.0f, (b[3] - b[1]) / 2.0f);
+	if (Cull(Fvec2(b[0] + half[0], b[1] + half[1]), half))
+		return;
+
+	Fvec4 mode(texture ? 1.0f : 0.0f, float(glow), 0.0f, 0.0f);
+	Fvec2 uv0 = sub_texture ? sub_texture->uv_min : Fvec2(0.0f), uv1 = sub_texture ? sub_texture->uv_max : Fvec2(1.0f);
+	int total = int(path.fill.size() / 6);
+	float const* in = path.fill.data();
+	for (int first = 0; first < total; first += batch_capacity)
+	{
+		int count = std::min(total - first, batch_capacity);
+		float* out = BatchVertices(count, texture);
+		for (int i = 0; i < count; i++, in += 6) {
+			float const local[2] = { in[4], in[5] };
+			write_vertex(out, Fvec2(in[0], in[1]), uv0[0] + (uv1[0] - uv0[0]) * in[2], uv0[1] + (uv1[1] - uv0[1]) * in[3],
+				color, local, half, mode);
+		}
+	}
+
+	if (!batching && !deferred) Flush();
+}
+
+void Graphics2D::StrokePath(Path2D const& path)
+{
+	TessellatePath(path);
+	for (Path2D::Contour const& c : path.contours)
+		if (c.count > 1) DrawStroke(std::span<Fvec2 const>(path.flattened.data() + c.first, c.count), c.closed);
 }
 
 void Graphics2D::DrawText(std::string const& str, float x, float y)
 {
-	shader.SetUniform("u_draw_text", 1);
-	Fvec2 text_size(0.0f);
-	for (int i = 0u; i < str.size(); i++) {
-		Glyph glyph = (*font)[str[i]];
-		text_size[0] += glyph.advance >> 6;
-		if (glyph.bearing[1] > text_size[1])
-			text_size = glyph.bearing[1];
+	if (str.empty()) return;
+	std::vector<float>* vertices = &text_runs.scratch;
+	Graphics2D_TextRun* run = nullptr;
+
+	if (text_cache != NoTextCache)
+	{
+		text_runs.Sweep();
+		auto& runs = text_runs.fonts[font][align];
+		auto it = runs.find(std::string_view(str));
+		if (it == runs.end()) {
+			it = runs.emplace(str, Graphics2D_TextRun{}).first;
+			layout_text(*font, str, align, it->second.vertices);
+			it->second.atlas = font->GetAtlas();
+			it->second.bounds = text_bounds(it->second.vertices);
+		}
+		run = &it->second;
+		run->last_used = PrivateControl::Instance().frame;
+		vertices = &run->vertices;
 	}
+	else layout_text(*font, str, align, *vertices);
 
-	float char_x = 0.0f;
-	for (int i = 0u; i < str.size(); i++)
+	// glyphs are laid out in font pixels, and scaled only when transformed
+	float scale = text_size > 0.0f ? text_size / font->GetPixelSize() : 1.0f;
+
+	Fvec4 bounds = run ? run->bounds : text_bounds(*vertices);
+	Fvec2 local_center = Fvec2(bounds[0] + bounds[2], bounds[1] + bounds[3]) * (scale / 2.0f);
+	Fvec2 local_half = Fvec2(bounds[2] - bounds[0], bounds[3] - bounds[1]) * (scale / 2.0f);
+	float ac = std::abs(rotation_cos), as = std::abs(rotation_sin);
+	Fvec2 center = Fvec2(x, y) + rotate_point(local_center[0], local_center[1], rotation_cos, rotation_sin);
+	Fvec2 extent(ac * local_half[0] + as * local_half[1], as * local_half[0] + ac * local_half[1]);
+	if (Cull(center, extent))
+		return;
+
+	// resident runs are drawn straight from their vertex buffer with a single model transform
+	if (text_cache == TextCacheGPU && !recording)
 	{
-		Glyph glyph = (*font)[str[i]];
-		float xpos = char_x + glyph.bearing[0];
-		float ypos = (float)(glyph.bearing[1] - glyph.size[1]);
-		float w = (float)glyph.size[0];
-		float h = (float)glyph.size[1];
-
-		Fmat4 model = Translate(Fvec2(xpos + w / 2.0f, ypos + h / 2.0f - text_size[1] / 2.0f)) * Scale(Fvec2(w, h));
-		if (align == AlignCenter) model = Translate(Fvec2(-text_size[0] / 2.0f, 0.0f)) * model;
-		else if (align == AlignRight) model = Translate(Fvec2(-text_size[0], 0.0f)) * model;
-		model = Translate(Fvec2(x, y)) * Rotate(rotation) * model;
-
-		glyph.texture->Bind(0);
-		shader.SetUniform("u_model", model);
-		shader.Draw("Maya_2D_vao_square");
-		char_x += glyph.advance >> 6;
+		if (!run->vao) text_runs.MakeResident(*run);
+		if (PrivateControl::Instance().damage.Tracking()) {
+			float const params[10] = { x, y, rotation, scale, color[0], color[1], color[2], color[3], float(glow), float(align) };
+			std::uint64_t h = HashBytes(str.data(), str.size());
+			h = HashBytes(&font, sizeof(font), HashBytes(params, sizeof(params), h));
+			ReportExternalDraw(Fvec4(center[0] - extent[0], center[1] - extent[1], center[0] + extent[0], center[1] + extent[1]), h);
+		}
+		Fmat4 model = Translate(Fvec2(x, y)) * Rotate(rotation) * Scale(Fvec2(scale));
+		ExternalDraw(0, run->atlas, font->IsSDF() ? 3 : 2,
+			[vao = run->vao, n = int(vertices->size() / 4), color = color, glow = glow, model](Shader& shader) {
+				SendExternalColor(color, glow);
+				shader.SetUniform("u_model", model);
+				vao->Draw(0, n);
+			});
+		return;
 	}
-	shader.SetUniform("u_draw_text", 0);
+
+	// every glyph lives in the font atlas, so the whole string is a single batch
+	Fvec2 position(x, y);
+	Fvec4 mode(font->IsSDF() ? 3.0f : 2.0f, float(glow), 0.0f, 0.0f);
+	float c = rotation_cos * scale, s = rotation_sin * scale;
+	float const* in = vertices->data();
+	int total = int(vertices->size() / 4);
+
+	for (int first = 0; first < total; first += batch_capacity)
+	{
+		int count = std::min(total - first, batch_capacity);
+		float* out = BatchVertices(count, font->GetAtlas());
+		for (int i = 0; i < count; i++, in += 4)
+			write_vertex(out, position + rotate_point(in[0], in[1], c, s), in[2], in[3], color,
+				quad_corners[quad_indices[(first + i) % 6]], Fvec2(1.0f), mode);
+	}
+
+	if (!batching && !deferred) Flush();
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,251 @@
+#include "../private_control.hpp"
+#include <Maya2D.hpp>
+
+#if defined(__AVX__)
+#define MAYA_PARTICLES_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAYA_PARTICLES_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace Maya {
+
+// y[i] += x[i] * s
+static void particles_axpy(float* y, float const* x, std::size_t n, float s)
+{
+	std::size_t i = 0;
+#if MAYA_PARTICLES_AVX
+	__m256 vs = _mm256_set1_ps(s);
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(x + i), vs)));
+#elif MAYA_PARTICLES_SSE
+	__m128 vs = _mm_set1_ps(s);
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(x + i), vs)));
+#endif
+	for (; i < n; i++) y[i] += x[i] * s;
+}
+
+// y[i] += s
+static void particles_add(float* y, std::size_t n, float s)
+{
+	std::size_t i = 0;
+#if MAYA_PARTICLES_AVX
+	__m256 vs = _mm256_set1_ps(s);
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), vs));
+#elif MAYA_PARTICLES_SSE
+	__m128 vs = _mm_set1_ps(s);
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), vs));
+#endif
+	for (; i < n; i++) y[i] += s;
+}
+
+// y[i] = y[i] * a + b[i % 2], for interleaved x and y components
+static void particles_scale_offset2(float* y, std::size_t n, float a, float b0, float b1)
+{
+	std::size_t i = 0;
+#if MAYA_PARTICLES_AVX
+	__m256 va = _mm256_set1_ps(a), vb = _mm256_setr_ps(b0, b1, b0, b1, b0, b1, b0, b1);
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(y + i), va), vb));
+#elif MAYA_PARTICLES_SSE
+	__m128 va = _mm_set1_ps(a), vb = _mm_setr_ps(b0, b1, b0, b1);
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(y + i), va), vb));
+#endif
+	for (; i < n; i++) y[i] = y[i] * a + (i % 2 ? b1 : b0);
+}
+
+// Interpolate colors and scales by the fraction of the lifetime spent
+static void particles_interpolate(float* colors, float* scales, float const* ages, float const* inv_lifetimes, std::size_t n,
+	Fvec4 const& c0, Fvec4 const& c1, Fvec2 const& s0, Fvec2 const& s1)
+{
+#if MAYA_PARTICLES_AVX || MAYA_PARTICLES_SSE
+	__m128 vc0 = _mm_setr_ps(c0[0], c0[1], c0[2], c0[3]);
+	__m128 vdc = _mm_sub_ps(_mm_setr_ps(c1[0], c1[1], c1[2], c1[3]), vc0);
+	__m128 vs0 = _mm_setr_ps(s0[0], s0[1], s0[0], s0[1]);
+	__m128 vds = _mm_sub_ps(_mm_setr_ps(s1[0], s1[1], s1[0], s1[1]), vs0);
+	std::size_t i = 0;
+	for (; i + 2 <= n; i += 2)
+	{
+		float t0 = std::min(ages[i] * inv_lifetimes[i], 1.0f), t1 = std::min(ages[i + 1] * inv_lifetimes[i + 1], 1.0f);
+		_mm_storeu_ps(colors + i * 4, _mm_add_ps(vc0, _mm_mul_ps(vdc, _mm_set1_ps(t0))));
+		_mm_storeu_ps(colors + i * 4 + 4, _mm_add_ps(vc0, _mm_mul_ps(vdc, _mm_set1_ps(t1))));
+		_mm_storeu_ps(scales + i * 2, _mm_add_ps(vs0, _mm_mul_ps(vds, _mm_setr_ps(t0, t0, t1, t1))));
+	}
+	for (; i < n; i++)
+#else
+	for (std::size_t i = 0; i < n; i++)
+#endif
+	{
+		float t = std::min(ages[i] * inv_lifetimes[i], 1.0f);
+		for (int k = 0; k < 4; k++) colors[i * 4 + k] = c0[k] + (c1[k] - c0[k]) * t;
+		for (int k = 0; k < 2; k++) scales[i * 2 + k] = s0[k] + (s1[k] - s0[k]) * t;
+	}
+}
+
+ParticleEmitter::ParticleEmitter(unsigned int capacity)
+	: positions(capacity), velocities(capacity), scales(capacity), colors(capacity),
+	  rotations(capacity), spins(capacity), ages(capacity), inv_lifetimes(capacity),
+	  count(0), capacity(capacity), texture(nullptr), position(0.0f), gravity(0.0f), rate(0), pending(0),
+	  lifetime{ 1.0f, 1.0f }, speed{ 0.0f, 0.0f }, spin{ 0.0f, 0.0f }, direction(0), spread(6.2831853f), drag(0),
+	  color_start(1.0f), color_end(1.0f), size_start(1.0f), size_end(1.0f), seed(0x9E3779B9u)
+{
+}
+
+void ParticleEmitter::SetTexture(Texture* texture)
+{
+	this->texture = texture;
+}
+
+void ParticleEmitter::SetPosition(Fvec2 position)
+{
+	this->position = position;
+}
+
+void ParticleEmitter::SetRate(float per_second)
+{
+	rate = per_second;
+}
+
+void ParticleEmitter::SetLifetime(float min, float max)
+{
+	lifetime[0] = std::max(min, 0.0001f);
+	lifetime[1] = std::max(max, lifetime[0]);
+}
+
+void ParticleEmitter::SetSpeed(float min, float max)
+{
+	speed[0] = min;
+	speed[1] = max;
+}
+
+void ParticleEmitter::SetDirection(float radian, float spread)
+{
+	direction = radian;
+	this->spread = spread;
+}
+
+void ParticleEmitter::SetSpin(float min, float max)
+{
+	spin[0] = min;
+	spin[1] = max;
+}
+
+void ParticleEmitter::SetGravity(Fvec2 acceleration)
+{
+	gravity = acceleration;
+}
+
+void ParticleEmitter::SetDrag(float drag)
+{
+	this->drag = drag;
+}
+
+void ParticleEmitter::SetColor(Fvec4 start, Fvec4 end)
+{
+	color_start = start;
+	color_end = end;
+}
+
+void ParticleEmitter::SetSize(Fvec2 start, Fvec2 end)
+{
+	size_start = start;
+	size_end = end;
+}
+
+float ParticleEmitter::Random()
+{
+	// xorshift32, quality is not a concern for particles
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return (seed >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticleEmitter::Emit(unsigned int n)
+{
+	n = std::min(n, capacity - count);
+	for (unsigned int i = count; i < count + n; i++)
+	{
+		float angle = direction + (Random() - 0.5f) * spread;
+		float v = speed[0] + (speed[1] - speed[0]) * Random();
+		positions[i] = position;
+		velocities[i] = Fvec2(std::cos(angle) * v, std::sin(angle) * v);
+		scales[i] = size_start;
+		colors[i] = color_start;
+		rotations[i] = 0.0f;
+		spins[i] = spin[0] + (spin[1] - spin[0]) * Random();
+		ages[i] = 0.0f;
+		inv_lifetimes[i] = 1.0f / (lifetime[0] + (lifetime[1] - lifetime[0]) * Random());
+	}
+	count += n;
+}
+
+void ParticleEmitter::Update(float dt)
+{
+	// advance first so that particles reaching their lifetime this frame are never drawn
+	if (count)
+	{
+		float* pos = &positions[0][0];
+		float* vel = &velocities[0][0];
+		particles_scale_offset2(vel, count * 2, std::max(1.0f - drag * dt, 0.0f), gravity[0] * dt, gravity[1] * dt);
+		particles_axpy(pos, vel, count * 2, dt);
+		particles_axpy(rotations.data(), spins.data(), count, dt);
+		particles_add(ages.data(), count, dt);
+		particles_interpolate(&colors[0][0], &scales[0][0], ages.data(), inv_lifetimes.data(), count,
+			color_start, color_end, size_start, size_end);
+	}
+
+	// compact dead particles by moving the last alive one into their slot, order is not kept
+	for (unsigned int i = 0; i < count;)
+	{
+		if (ages[i] * inv_lifetimes[i] < 1.0f) {
+			i++;
+			continue;
+		}
+		unsigned int last = --count;
+		positions[i] = positions[last];
+		velocities[i] = velocities[last];
+		scales[i] = scales[last];
+		colors[i] = colors[last];
+		rotations[i] = rotations[last];
+		spins[i] = spins[last];
+		ages[i] = ages[last];
+		inv_lifetimes[i] = inv_lifetimes[last];
+	}
+
+	// emit into the freed slots, new particles start at the emitter this frame
+	if (rate > 0.0f) {
+		pending += rate * dt;
+		unsigned int n = (unsigned int)pending;
+		pending -= float(n);
+		Emit(n);
+	}
+}
+
+void ParticleEmitter::Draw(Graphics2D& g) const
+{
+	SpriteBatch::Draw(g, texture, count, positions.data(), scales.data(), rotations.data(), colors.data());
+}
+
+void ParticleEmitter::Clear()
+{
+	count = 0;
+	pending = 0;
+}
+
+unsigned int ParticleEmitter::Size() const
+{
+	return count;
+}
+
+unsigned int ParticleEmitter::Capacity() const
+{
+	return capacity;
+}
+
+}
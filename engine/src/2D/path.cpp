@@ -0,0 +1,246 @@
+#include "../private_control.hpp"
+#include <Maya2D.hpp>
+
+namespace Maya {
+
+Path2D::Path2D()
+	: bounds(0.0f), tolerance(0), fill_valid(false)
+{
+}
+
+void Path2D::Invalidate()
+{
+	tolerance = 0;
+	fill_valid = false;
+}
+
+void Path2D::MoveTo(Fvec2 point)
+{
+	verbs.push_back(Move);
+	points.push_back(point);
+	Invalidate();
+}
+
+void Path2D::LineTo(Fvec2 point)
+{
+	if (verbs.empty()) return MoveTo(point);
+	verbs.push_back(Line);
+	points.push_back(point);
+	Invalidate();
+}
+
+void Path2D::QuadraticTo(Fvec2 control, Fvec2 end)
+{
+	if (verbs.empty()) MoveTo(control);
+	verbs.push_back(Quadratic);
+	points.push_back(control);
+	points.push_back(end);
+	Invalidate();
+}
+
+void Path2D::CubicTo(Fvec2 control1, Fvec2 control2, Fvec2 end)
+{
+	if (verbs.empty()) MoveTo(control1);
+	verbs.push_back(Cubic);
+	points.push_back(control1);
+	points.push_back(control2);
+	points.push_back(end);
+	Invalidate();
+}
+
+void Path2D::Close()
+{
+	if (verbs.empty() || verbs.back() == CloseContour) return;
+	verbs.push_back(CloseContour);
+	Invalidate();
+}
+
+void Path2D::Clear()
+{
+	verbs.clear();
+	points.clear();
+	Invalidate();
+}
+
+void Path2D::Flatten(float tolerance) const
+{
+	this->tolerance = tolerance;
+	fill_valid = false;
+	flattened.clear();
+	contours.clear();
+
+	Fvec2 start(0.0f);
+	bool open = false;
+	auto begin_contour = [&](Fvec2 point) {
+		contours.push_back({ int(flattened.size()), 0, false });
+		flattened.push_back(point);
+		open = true;
+	};
+	auto end_contour = [&](bool closed) {
+		if (!open) return;
+		Contour& c = contours.back();
+		c.count = int(flattened.size()) - c.first;
+		c.closed = closed;
+		open = false;
+	};
+
+	// the number of segments keeps the distance between a curve and its polyline under the tolerance
+	std::size_t p = 0;
+	for (Verb verb : verbs)
+	{
+		if (verb != Move && verb != CloseContour && !open) begin_contour(start);
+		switch (verb)
+		{
+		case Move:
+			end_contour(false);
+			start = points[p++];
+			begin_contour(start);
+			break;
+		case Line:
+			flattened.push_back(points[p++]);
+			break;
+		case Quadratic:
+		{
+			Fvec2 p0 = flattened.back(), p1 = points[p], p2 = points[p + 1];
+			float dd = Fvec2(p0 - p1 * 2.0f + p2).Norm();
+			int n = std::clamp(int(std::ceil(std::sqrt(dd / (4.0f * tolerance)))), 1, 256);
+			for (int i = 1; i <= n; i++) {
+				float t = float(i) / n, u = 1.0f - t;
+				flattened.push_back(p0 * (u * u) + p1 * (2.0f * u * t) + p2 * (t * t));
+			}
+			p += 2;
+			break;
+		}
+		case Cubic:
+		{
+			Fvec2 p0 = flattened.back(), p1 = points[p], p2 = points[p + 1], p3 = points[p + 2];
+			float dd = std::max(Fvec2(p0 - p1 * 2.0f + p2).Norm(), Fvec2(p1 - p2 * 2.0f + p3).Norm());
+			int n = std::clamp(int(std::ceil(std::sqrt(0.75f * dd / tolerance))), 1, 256);
+			for (int i = 1; i <= n; i++) {
+				float t = float(i) / n, u = 1.0f - t;
+				flattened.push_back(p0 * (u * u * u) + p1 * (3.0f * u * u * t) + p2 * (3.0f * u * t * t) + p3 * (t * t * t));
+			}
+			p += 3;
+			break;
+		}
+		case CloseContour:
+			// segments after a close start a new contour from the same point
+			end_contour(true);
+			break;
+		}
+	}
+	end_contour(false);
+
+	if (flattened.empty()) return;
+	bounds = Fvec4(flattened[0][0], flattened[0][1], flattened[0][0], flattened[0][1]);
+	for (Fvec2 const& v : flattened) {
+		bounds[0] = std::min(bounds[0], v[0]);
+		bounds[1] = std::min(bounds[1], v[1]);
+		bounds[2] = std::max(bounds[2], v[0]);
+		bounds[3] = std::max(bounds[3], v[1]);
+	}
+}
+
+static float cross(Fvec2 const& o, Fvec2 const& a, Fvec2 const& b)
+{
+	return (a[0] - o[0]) * (b[1] - o[1]) - (a[1] - o[1]) * (b[0] - o[0]);
+}
+
+// Check if p lies inside or on the edge of the counter clockwise triangle abc
+static bool in_triangle(Fvec2 const& p, Fvec2 const& a, Fvec2 const& b, Fvec2 const& c)
+{
+	return cross(a, b, p) >= 0.0f && cross(b, c, p) >= 0.0f && cross(c, a, p) >= 0.0f;
+}
+
+void Path2D::Triangulate() const
+{
+	fill_valid = true;
+	fill.clear();
+
+	Fvec2 size(std::max(bounds[2] - bounds[0], 1e-6f), std::max(bounds[3] - bounds[1], 1e-6f));
+	auto emit = [&](Fvec2 const& v) {
+		float u = (v[0] - bounds[0]) / size[0], w = (v[1] - bounds[1]) / size[1];
+		fill.insert(fill.end(), { v[0], v[1], u, w, u * 2.0f - 1.0f, w * 2.0f - 1.0f });
+	};
+
+	std::vector<int> polygon;
+	for (Contour const& c : contours)
+	{
+		// every contour is filled as a simple polygon, the closing edge is implied
+		int n = c.count;
+		Fvec2 const* v = &flattened[c.first];
+		if (n > 1 && v[0] == v[n - 1]) n--;
+		if (n < 3) continue;
+
+		float area = 0.0f;
+		bool convex = true;
+		float sign = 0.0f;
+		for (int i = 0; i < n; i++) {
+			Fvec2 const& a = v[i], & b = v[(i + 1) % n], & d = v[(i + 2) % n];
+			area += a[0] * b[1] - b[0] * a[1];
+			float turn = cross(a, b, d);
+			if (turn != 0.0f) {
+				if (sign != 0.0f && (turn > 0.0f) != (sign > 0.0f)) convex = false;
+				sign = turn;
+			}
+		}
+		if (area == 0.0f) continue;
+
+		// convex polygons are fanned from their first vertex
+		if (convex) {
+			for (int i = 1; i + 1 < n; i++) {
+				emit(v[0]);
+				emit(v[i]);
+				emit(v[i + 1]);
+			}
+			continue;
+		}
+
+		// ear clipping on a counter clockwise index list
+		polygon.resize(n);
+		for (int i = 0; i < n; i++) polygon[i] = area > 0.0f ? i : n - 1 - i;
+
+		int guard = 0;
+		for (int i = 0; polygon.size() > 3 && guard < int(polygon.size());)
+		{
+			int m = int(polygon.size());
+			int ia = polygon[(i + m - 1) % m], ib = polygon[i % m], ic = polygon[(i + 1) % m];
+			Fvec2 const& a = v[ia], & b = v[ib], & d = v[ic];
+
+			// collinear vertices are dropped without producing a triangle
+			float turn = cross(a, b, d);
+			if (turn == 0.0f) {
+				polygon.erase(polygon.begin() + i % m);
+				i = i % m == 0 ? 0 : i % m - 1;
+				continue;
+			}
+
+			bool ear = turn > 0.0f;
+			for (int k = 0; ear && k < m; k++) {
+				int j = polygon[k];
+				if (j == ia || j == ib || j == ic) continue;
+				if (in_triangle(v[j], a, b, d)) ear = false;
+			}
+
+			if (ear) {
+				emit(a);
+				emit(b);
+				emit(d);
+				polygon.erase(polygon.begin() + i % m);
+				guard = 0;
+				i = i % m == 0 ? 0 : i % m - 1;
+			}
+			else {
+				i = (i + 1) % m;
+				guard++;
+			}
+		}
+		if (polygon.size() == 3) {
+			emit(v[polygon[0]]);
+			emit(v[polygon[1]]);
+			emit(v[polygon[2]]);
+		}
+	}
+}
+
+}
@@ -0,0 +1,147 @@
+#include "../private_control.hpp"
+#include <Maya2D.hpp>
+
+namespace Maya {
+
+static float sprite_vertices[] = {
+	-0.5f, -0.5f, 0, 0,
+	-0.5f, 0.5f, 0, 1,
+	0.5f, -0.5f, 1, 0,
+	-0.5f, 0.5f, 0, 1,
+	0.5f, -0.5f, 1, 0,
+	0.5f, 0.5f, 1, 1
+};
+
+// Number of sprites submitted by a single instanced draw call
+constexpr static int sprite_capacity = 65536;
+
+// Floats per sprite of each instanced attribute: position, scale, rotation, color and rect
+constexpr static int sprite_floats[5] = { 2, 2, 1, 4, 4 };
+
+// Unit square with one buffer per sprite attribute, shared by every SpriteBatch
+static struct SpriteBatch_Instances
+{
+	VertexArray* vao = nullptr;
+	std::vector<float> zeros;
+	std::vector<Fvec4> ones, full_rects;
+
+	VertexArray& Get()
+	{
+		if (vao) return *vao;
+		auto instanced = [](int count, int location) {
+			VertexLayout layout(count);
+			layout.location = location;
+			layout.divisor = 1;
+			layout.count = sprite_capacity;
+			return std::make_pair((float*)nullptr, layout);
+		};
+		VertexDataStruct vds = {
+			{ sprite_vertices, VertexLayout(2, 2) },
+			instanced(2, 5), instanced(2, 6), instanced(1, 7), instanced(4, 8), instanced(4, 9)
+		};
+		vao = new VertexArray(vds, 6);
+		zeros.assign(sprite_capacity, 0.0f);
+		ones.assign(sprite_capacity, Fvec4(1.0f));
+		full_rects.assign(sprite_capacity, SpriteBatch::FullRect);
+		return *vao;
+	}
+} instances;
+
+SpriteBatch::SpriteBatch(Texture* texture)
+	: texture(texture)
+{
+}
+
+void SpriteBatch::SetTexture(Texture* texture)
+{
+	this->texture = texture;
+}
+
+void SpriteBatch::Reserve(unsigned int count)
+{
+	positions.reserve(count);
+	scales.reserve(count);
+	rotations.reserve(count);
+	colors.reserve(count);
+	rects.reserve(count);
+}
+
+void SpriteBatch::Clear()
+{
+	positions.clear();
+	scales.clear();
+	rotations.clear();
+	colors.clear();
+	rects.clear();
+}
+
+unsigned int SpriteBatch::Push(Fvec2 position, Fvec2 scale, float rotation, Fvec4 color, Fvec4 rect)
+{
+	positions.push_back(position);
+	scales.push_back(scale);
+	rotations.push_back(rotation);
+	colors.push_back(color);
+	rects.push_back(rect);
+	return Size() - 1;
+}
+
+unsigned int SpriteBatch::Size() const
+{
+	return positions.size();
+}
+
+void SpriteBatch::Draw(Graphics2D& g) const
+{
+#if MAYA_DEBUG
+	if (scales.size() != Size() || rotations.size() != Size() || colors.size() != Size() || rects.size() != Size()) {
+		std::cout << "Attempting to call SpriteBatch::Draw with arrays of different sizes\n";
+		return;
+	}
+#endif
+	Draw(g, texture, Size(), positions.data(), scales.data(), rotations.data(), colors.data(), rects.data());
+}
+
+void SpriteBatch::Draw(Graphics2D& g, Texture* texture, unsigned int count,
+	Fvec2 const* positions, Fvec2 const* scales, float const* rotations, Fvec4 const* colors, Fvec4 const* rects)
+{
+	if (!count) return;
+	VertexArray& vao = instances.Get();
+
+	for (unsigned int first = 0; first < count; first += sprite_capacity)
+	{
+		int n = std::min(count - first, (unsigned int)sprite_capacity);
+		if (PrivateControl::Instance().damage.Tracking())
+		{
+			// a rotated sprite stays inside the circle around its scale
+			Fvec4 bounds(1e9f, 1e9f, -1e9f, -1e9f);
+			for (int i = first; i < int(first) + n; i++) {
+				float r = std::max(std::abs(scales[i][0]), std::abs(scales[i][1])) * 0.7072f;
+				bounds = Fvec4(std::min(bounds[0], positions[i][0] - r), std::min(bounds[1], positions[i][1] - r),
+					std::max(bounds[2], positions[i][0] + r), std::max(bounds[3], positions[i][1] + r));
+			}
+			std::uint64_t h = HashBytes(&texture, sizeof(texture));
+			h = HashBytes(&positions[first], sizeof(Fvec2) * n, h);
+			h = HashBytes(&scales[first], sizeof(Fvec2) * n, h);
+			if (rotations) h = HashBytes(rotations + first, sizeof(float) * n, h);
+			if (colors) h = HashBytes(&colors[first], sizeof(Fvec4) * n, h);
+			if (rects) h = HashBytes(&rects[first], sizeof(Fvec4) * n, h);
+			g.ReportExternalDraw(bounds, h);
+		}
+		float const* data[5] = { &positions[first][0], &scales[first][0], rotations ? rotations + first : instances.zeros.data(),
+			colors ? &colors[first][0] : &instances.ones[0][0], rects ? &rects[first][0] : &instances.full_rects[0][0] };
+
+		// deferred draws run after the caller's arrays could have changed, so they upload copies
+		std::vector<float> copy;
+		if (PrivateControl::Instance().damage.Deferring())
+			for (int b = 0; b < 5; b++)
+				copy.insert(copy.end(), data[b], data[b] + sprite_floats[b] * n);
+
+		g.ExternalDraw(2, texture, texture ? 2 : 0, [vao = &vao, data, copy = std::move(copy), n](Shader&) {
+			for (int b = 0, offset = 0; b < 5; offset += sprite_floats[b] * n, b++)
+				vao->UpdateVBO(b + 1, copy.empty() ? data[b] : copy.data() + offset, n);
+			vao->DrawInstanced(n);
+		});
+	}
+}
+
+}
@@ -0,0 +1,169 @@
+#include "../private_control.hpp"
+#include <Maya2D.hpp>
+
+namespace Maya {
+
+// Vertices of a full chunk, 6 per tile
+constexpr static int chunk_capacity = Tilemap::ChunkSize * Tilemap::ChunkSize * 6;
+
+// Chunk vertex arrays released by destroyed tilemaps, all of them have chunk_capacity vertices
+static std::vector<VertexArray*> chunk_vaos;
+
+// Vertices of the chunk being built: position (2), texture coordinate (2)
+static std::vector<float> chunk_vertices;
+
+// Source of chunk revisions, unique across every tilemap
+static std::uint64_t next_revision = 0;
+
+Tilemap::Tilemap(Ivec2 size, Fvec2 tile_size, Texture* tileset, Ivec2 grid)
+	: size(size), tile_size(tile_size), position(0.0f), tileset(tileset), grid(grid)
+{
+	chunks = Ivec2((size[0] + ChunkSize - 1) / ChunkSize, (size[1] + ChunkSize - 1) / ChunkSize);
+	tiles.assign(std::size_t(size[0]) * size[1], Empty);
+	chunk_data.resize(std::size_t(chunks[0]) * chunks[1]);
+	for (Chunk& chunk : chunk_data) chunk.revision = ++next_revision;
+}
+
+Tilemap::~Tilemap()
+{
+	for (Chunk& chunk : chunk_data)
+		if (chunk.vao) chunk_vaos.push_back(chunk.vao);
+}
+
+void Tilemap::SetTile(int x, int y, int tile)
+{
+#if MAYA_DEBUG
+	if (x < 0 || y < 0 || x >= size[0] || y >= size[1]) {
+		std::cout << "Tile (" << x << ", " << y << ") is outside the tilemap\n";
+		return;
+	}
+#endif
+	int& current = tiles[std::size_t(y) * size[0] + x];
+	if (current == tile) return;
+	current = tile;
+	Chunk& chunk = chunk_data[std::size_t(y / ChunkSize) * chunks[0] + x / ChunkSize];
+	chunk.dirty = true;
+	chunk.revision = ++next_revision;
+}
+
+int Tilemap::GetTile(int x, int y) const
+{
+	return tiles[std::size_t(y) * size[0] + x];
+}
+
+void Tilemap::Fill(int tile)
+{
+	std::fill(tiles.begin(), tiles.end(), tile);
+	for (Chunk& chunk : chunk_data) {
+		chunk.dirty = true;
+		chunk.revision = ++next_revision;
+	}
+}
+
+void Tilemap::SetPosition(Fvec2 position)
+{
+	this->position = position;
+}
+
+Fvec2 Tilemap::GetPosition() const
+{
+	return position;
+}
+
+Ivec2 Tilemap::GetSize() const
+{
+	return size;
+}
+
+void Tilemap::Build(int cx, int cy)
+{
+	Chunk& chunk = chunk_data[std::size_t(cy) * chunks[0] + cx];
+	chunk.dirty = false;
+	chunk_vertices.clear();
+
+	// inset texture coordinates by half a texel so that neighbouring tiles never bleed in
+	Ivec2 texels = tileset ? tileset->GetSize() : Ivec2(1);
+	Fvec2 inset(0.5f / std::max(texels[0], 1), 0.5f / std::max(texels[1], 1));
+
+	int x1 = std::min((cx + 1) * ChunkSize, size[0]), y1 = std::min((cy + 1) * ChunkSize, size[1]);
+	for (int y = cy * ChunkSize; y < y1; y++)
+	{
+		for (int x = cx * ChunkSize; x < x1; x++)
+		{
+			int tile = tiles[std::size_t(y) * size[0] + x];
+			if (tile < 0) continue;
+			int column = tile % grid[0], row = tile / grid[0];
+			float u0 = float(column) / grid[0] + inset[0], u1 = float(column + 1) / grid[0] - inset[0];
+			float v0 = 1.0f - float(row + 1) / grid[1] + inset[1], v1 = 1.0f - float(row) / grid[1] - inset[1];
+			float px0 = x * tile_size[0], px1 = px0 + tile_size[0];
+			float py0 = y * tile_size[1], py1 = py0 + tile_size[1];
+			chunk_vertices.insert(chunk_vertices.end(), {
+				px0, py0, u0, v0,	px0, py1, u0, v1,	px1, py0, u1, v0,
+				px0, py1, u0, v1,	px1, py0, u1, v0,	px1, py1, u1, v1
+			});
+		}
+	}
+
+	chunk.count = int(chunk_vertices.size() / 4);
+	if (!chunk.count && !chunk.vao) return;
+	if (chunk.vao) {
+		chunk.vao->UpdateVBO(0, chunk_vertices.data(), chunk.count);
+	}
+	else if (!chunk_vaos.empty()) {
+		chunk.vao = chunk_vaos.back();
+		chunk_vaos.pop_back();
+		chunk.vao->UpdateVBO(0, chunk_vertices.data(), chunk.count);
+	}
+	else {
+		// the first upload goes into a static buffer, most chunks are never edited afterwards
+		chunk_vertices.resize(chunk_capacity * 4);
+		VertexDataStruct vds = { { chunk_vertices.data(), VertexLayout(2, 2) } };
+		chunk.vao = new VertexArray(vds, chunk_capacity);
+	}
+}
+
+void Tilemap::Draw(Graphics2D& g, Fvec4 const& tint)
+{
+	Fvec2 extent = tile_size * float(ChunkSize);
+	Ivec2 first(0), last = chunks - Ivec2(1);
+	if (g.culling)
+	{
+		g.UpdateView();
+		first = Ivec2(int(std::floor((g.visible[0] - position[0]) / extent[0])), int(std::floor((g.visible[1] - position[1]) / extent[1])));
+		last = Ivec2(int(std::floor((g.visible[2] - position[0]) / extent[0])), int(std::floor((g.visible[3] - position[1]) / extent[1])));
+		for (int i = 0; i < 2; i++) {
+			first[i] = std::max(first[i], 0);
+			last[i] = std::min(last[i], chunks[i] - 1);
+		}
+	}
+
+	bool prepared = false;
+	bool tracking = PrivateControl::Instance().damage.Tracking();
+	for (int cy = first[1]; cy <= last[1]; cy++)
+	{
+		for (int cx = first[0]; cx <= last[0]; cx++)
+		{
+			Chunk& chunk = chunk_data[std::size_t(cy) * chunks[0] + cx];
+			if (chunk.dirty) Build(cx, cy);
+			if (!chunk.count) continue;
+
+			if (tracking) {
+				Fvec2 lo = position + Fvec2(extent[0] * cx, extent[1] * cy);
+				float const params[6] = { lo[0], lo[1], tint[0], tint[1], tint[2], tint[3] };
+				std::uint64_t h = HashBytes(params, sizeof(params), HashBytes(&chunk.revision, sizeof(chunk.revision)));
+				g.ReportExternalDraw(Fvec4(lo[0], lo[1], lo[0] + extent[0], lo[1] + extent[1]), HashBytes(&tileset, sizeof(tileset), h));
+			}
+
+			g.ExternalDraw(0, tileset, tileset ? 2 : 0, [vao = chunk.vao, n = chunk.count, prepared, tint, position = position](Shader& shader) {
+				if (!prepared) {
+					Graphics2D::SendExternalColor(tint);
+					shader.SetUniform("u_model", Translate(position));
+				}
+				vao->Draw(0, n);
+			});
+			prepared = true;
+		}
+	}
+}
+
+}
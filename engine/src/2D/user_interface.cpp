@@ -0,0 +1,274 @@
+#include "../private_control.hpp"
+#include <Maya2D.hpp>
+
+namespace Maya {
+
+constexpr static float ui_padding = 6.0f;
+constexpr static float ui_spacing = 4.0f;
+constexpr static float ui_row_height = 22.0f;
+constexpr static float ui_title_height = 24.0f;
+constexpr static float ui_text_size = 14.0f;
+constexpr static float ui_scroll_speed = 30.0f;
+
+// Colors of the widgets
+constexpr static unsigned int ui_panel_color = 0x1E1F24;
+constexpr static unsigned int ui_title_color = 0x2D3B55;
+constexpr static unsigned int ui_widget_color = 0x363842;
+constexpr static unsigned int ui_hovered_color = 0x454856;
+constexpr static unsigned int ui_active_color = 0x3A6FC4;
+constexpr static unsigned int ui_text_color = 0xE6E6E6;
+
+UserInterface::UserInterface()
+	: active(0), focused(0), window(0.0f), mouse(-1.0f), wheel(0),
+	  mouse_down(false), mouse_pressed(false), mouse_released(false),
+	  over_panel(false), wants_mouse(false), focus_claimed(false)
+{
+	g.SetBatching(true);
+	g.SetCulling(false);
+	g.SetTextSize(ui_text_size);
+}
+
+void UserInterface::OnEvent(Event const& e)
+{
+	if (auto* moved = EventCast<MouseMovedEvent>(e))
+		mouse = moved->position;
+	else if (auto* button = EventCast<MouseEvent>(e)) {
+		if (button->button != MouseButtonLeft) return;
+		mouse_down = button->down;
+		(button->down ? mouse_pressed : mouse_released) = true;
+	}
+	else if (auto* scrolled = EventCast<MouseScrolledEvent>(e))
+		wheel += float(scrolled->offset[1]);
+	else if (auto* ch = EventCast<CharEvent>(e)) {
+		if (ch->codepoint >= 32 && ch->codepoint < 127) typed.push_back(char(ch->codepoint));
+	}
+	else if (auto* key = EventCast<KeyEvent>(e)) {
+		if (key->down) keys.push_back(key->keycode);
+	}
+}
+
+void UserInterface::Begin()
+{
+	// world units are window pixels with the origin at the bottom left
+	window = GetWindowSize();
+	g.SetProjectionToWindow();
+	g.SetCameraPosition(window / 2.0f);
+	over_panel = false;
+	focus_claimed = false;
+}
+
+void UserInterface::End()
+{
+#if MAYA_DEBUG
+	if (!containers.empty()) std::cout << "UserInterface::End is called with unclosed panels or scroll regions\n";
+#endif
+	containers.clear();
+	g.ClearClip();
+	g.Flush();
+
+	if (mouse_pressed && !focus_claimed) focused = 0;
+	if (!mouse_down) active = 0;
+	wants_mouse = over_panel;
+	mouse_pressed = mouse_released = false;
+	wheel = 0;
+	typed.clear();
+	keys.clear();
+}
+
+bool UserInterface::WantsMouse() const
+{
+	return wants_mouse;
+}
+
+std::uint64_t UserInterface::MakeID(std::string_view label) const
+{
+	std::uint64_t parent = containers.empty() ? 0 : containers.back().id;
+	return (parent * 0x100000001B3ull) ^ std::hash<std::string_view>()(label);
+}
+
+Fvec4 UserInterface::NextRow(float height)
+{
+	Container& c = containers.back();
+	Fvec4 row(c.rect[0] + ui_padding, c.cursor, c.rect[2] - ui_padding * 2.0f, height);
+	c.cursor += height + ui_spacing;
+	return row;
+}
+
+bool UserInterface::Hovered(Fvec4 const& rect) const
+{
+	auto inside = [this](Fvec4 const& r) {
+		return mouse[0] >= r[0] && mouse[0] < r[0] + r[2] && mouse[1] >= r[1] && mouse[1] < r[1] + r[3];
+	};
+	return inside(rect) && (containers.empty() || inside(containers.back().clip));
+}
+
+void UserInterface::Clip(Fvec4 const& rect)
+{
+	g.SetClip(Fvec2(rect[0] + rect[2] / 2.0f, window[1] - rect[1] - rect[3] / 2.0f), Fvec2(rect[2], rect[3]));
+}
+
+void UserInterface::FillRect(Fvec4 const& rect, unsigned int hex, float opacity, float radius)
+{
+	Fvec2 center(rect[0] + rect[2] / 2.0f, window[1] - rect[1] - rect[3] / 2.0f);
+	g.SetColor(hex, opacity);
+	if (radius > 0.0f) g.DrawRoundedRect(center, Fvec2(rect[2], rect[3]), radius);
+	else g.DrawRect(center, Fvec2(rect[2], rect[3]));
+}
+
+void UserInterface::Text(std::string const& str, float x, float y, Graphics2D::TextAlignment align)
+{
+	if (str.empty()) return;
+	g.SetColor(ui_text_color);
+	g.SetTextAlignment(align);
+	g.DrawText(str, std::round(x), std::round(window[1] - y));
+}
+
+void UserInterface::BeginPanel(std::string const& title, Fvec2 position, Fvec2 size)
+{
+	Fvec4 rect(position[0], position[1], size[0], size[1]);
+	if (Hovered(rect)) over_panel = true;
+
+	g.ClearClip();
+	FillRect(rect, ui_panel_color, 0.92f);
+	FillRect(Fvec4(rect[0], rect[1], rect[2], ui_title_height), ui_title_color);
+	Text(title, rect[0] + ui_padding, rect[1] + ui_title_height / 2.0f, Graphics2D::AlignLeft);
+
+	Fvec4 body(rect[0], rect[1] + ui_title_height, rect[2], rect[3] - ui_title_height);
+	containers.push_back({ body, body, body[1] + ui_padding, std::hash<std::string>()(title) });
+	Clip(body);
+}
+
+void UserInterface::EndPanel()
+{
+	containers.pop_back();
+	if (containers.empty()) g.ClearClip();
+	else Clip(containers.back().clip);
+}
+
+void UserInterface::BeginScroll(std::string const& id, float height)
+{
+	Fvec4 rect = NextRow(height);
+	std::uint64_t uid = MakeID(id);
+	Fvec2& scroll = scrolls[uid];
+
+	if (Hovered(rect) && wheel != 0.0f) {
+		scroll[0] -= wheel * ui_scroll_speed;
+		wheel = 0.0f;
+	}
+	scroll[0] = std::clamp(scroll[0], 0.0f, std::max(scroll[1] - rect[3], 0.0f));
+
+	// the visible area is the region intersected with the clip of its parent
+	Fvec4 const& parent = containers.back().clip;
+	float x0 = std::max(rect[0], parent[0]), y0 = std::max(rect[1], parent[1]);
+	float x1 = std::min(rect[0] + rect[2], parent[0] + parent[2]), y1 = std::min(rect[1] + rect[3], parent[1] + parent[3]);
+	Fvec4 clip(x0, y0, std::max(x1 - x0, 0.0f), std::max(y1 - y0, 0.0f));
+
+	FillRect(rect, ui_panel_color, 0.6f);
+	containers.push_back({ rect, clip, rect[1] + ui_padding - scroll[0], uid });
+	Clip(clip);
+}
+
+void UserInterface::EndScroll()
+{
+	Container c = containers.back();
+	containers.pop_back();
+	Fvec2& scroll = scrolls[c.id];
+	scroll[1] = c.cursor + scroll[0] - c.rect[1];
+
+	Clip(containers.back().clip);
+	if (scroll[1] > c.rect[3])
+	{
+		// scroll bar along the right edge, its thumb covers the visible fraction of the content
+		float length = c.rect[3] * c.rect[3] / scroll[1];
+		float offset = (c.rect[3] - length) * scroll[0] / (scroll[1] - c.rect[3]);
+		FillRect(Fvec4(c.rect[0] + c.rect[2] - 4.0f, c.rect[1] + offset, 3.0f, length), ui_hovered_color, 1.0f, 1.5f);
+	}
+}
+
+void UserInterface::Label(std::string const& text)
+{
+	Fvec4 row = NextRow(ui_row_height);
+	Text(text, row[0], row[1] + row[3] / 2.0f, Graphics2D::AlignLeft);
+}
+
+bool UserInterface::Button(std::string const& label)
+{
+	Fvec4 row = NextRow(ui_row_height);
+	std::uint64_t id = MakeID(label);
+	bool hovered = Hovered(row);
+	if (hovered && mouse_pressed) active = id;
+	bool clicked = hovered && mouse_released && active == id;
+
+	FillRect(row, active == id ? ui_active_color : (hovered ? ui_hovered_color : ui_widget_color), 1.0f, 3.0f);
+	Text(label, row[0] + row[2] / 2.0f, row[1] + row[3] / 2.0f, Graphics2D::AlignCenter);
+	return clicked;
+}
+
+bool UserInterface::Slider(std::string const& label, float& value, float min, float max)
+{
+	Fvec4 row = NextRow(ui_row_height);
+	std::uint64_t id = MakeID(label);
+	bool hovered = Hovered(row);
+	if (hovered && mouse_pressed) active = id;
+
+	float previous = value;
+	if (active == id && row[2] > 0.0f)
+		value = min + std::clamp((mouse[0] - row[0]) / row[2], 0.0f, 1.0f) * (max - min);
+
+	float fraction = max > min ? std::clamp((value - min) / (max - min), 0.0f, 1.0f) : 0.0f;
+	FillRect(row, hovered || active == id ? ui_hovered_color : ui_widget_color, 1.0f, 3.0f);
+	FillRect(Fvec4(row[0], row[1], row[2] * fraction, row[3]), ui_active_color, 1.0f, 3.0f);
+
+	char text[32];
+	std::snprintf(text, sizeof(text), "%.3g", value);
+	Text(label, row[0] + ui_padding, row[1] + row[3] / 2.0f, Graphics2D::AlignLeft);
+	Text(text, row[0] + row[2] - ui_padding, row[1] + row[3] / 2.0f, Graphics2D::AlignRight);
+	return !(previous == value);
+}
+
+bool UserInterface::TextField(std::string const& label, std::string& text)
+{
+	Fvec4 row = NextRow(ui_row_height);
+	std::uint64_t id = MakeID(label);
+	bool hovered = Hovered(row);
+	if (hovered && mouse_pressed) {
+		focused = id;
+		focus_claimed = true;
+	}
+
+	bool changed = false;
+	if (focused == id)
+	{
+		if (!typed.empty()) {
+			text += typed;
+			changed = true;
+		}
+		for (KeyCode key : keys) {
+			if (key == KeyBackspace && !text.empty()) {
+				text.pop_back();
+				changed = true;
+			}
+			else if (key == KeyEnter || key == KeyEscape)
+				focused = 0;
+		}
+	}
+
+	FillRect(row, focused == id ? ui_hovered_color : ui_widget_color, 1.0f, 3.0f);
+	float x = row[0] + ui_padding;
+	float y = row[1] + row[3] / 2.0f;
+	if (text.empty() && focused != id) {
+		g.SetColor(ui_text_color, 0.4f);
+		g.SetTextAlignment(Graphics2D::AlignLeft);
+		g.DrawText(label, std::round(x), std::round(window[1] - y));
+	}
+	else Text(text, x, y, Graphics2D::AlignLeft);
+
+	// blinking caret after the last character
+	if (focused == id && PrivateControl::Instance().frame / 30 % 2 == 0) {
+		float caret = x + g.MeasureText(text)[0] + 1.0f;
+		FillRect(Fvec4(caret, row[1] + 4.0f, 1.0f, row[3] - 8.0f), ui_text_color);
+	}
+	return changed;
+}
+
+}
@@ -0,0 +1,358 @@
+#include "../private_control.hpp"
+#include <Maya3D.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAYA_BVH_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace Maya {
+
+constexpr static int bvh_null = -1;
+
+Frustum::Frustum(Fmat4 const& m)
+{
+	// Gribb and Hartmann, every clip plane is the last row plus or minus another one
+	for (int i = 0; i < 6; i++)
+	{
+		int row = i / 2;
+		float sign = i % 2 ? -1.0f : 1.0f;
+		Fvec4 plane;
+		for (int c = 0; c < 4; c++) plane[c] = m.Get(3, c) + sign * m.Get(row, c);
+		float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		planes[i] = length > 0.0f ? plane / length : plane;
+	}
+}
+
+bool Frustum::Intersects(Fvec3 min, Fvec3 max) const
+{
+	for (auto const& p : planes) {
+		// the corner furthest along the normal
+		float d = p[3];
+		for (int k = 0; k < 3; k++) d += p[k] * (p[k] >= 0.0f ? max[k] : min[k]);
+		if (d < 0.0f) return false;
+	}
+	return true;
+}
+
+void TransformBounds(Fmat4 const& m, Fvec3& min, Fvec3& max)
+{
+	// Arvo, the extent along each axis is the sum of the absolute rotated extents
+	Fvec3 center = (min + max) / 2.0f, extent = (max - min) / 2.0f;
+	Fvec3 c, e;
+	for (int r = 0; r < 3; r++) {
+		c[r] = m.Get(r, 3);
+		e[r] = 0.0f;
+		for (int k = 0; k < 3; k++) {
+			c[r] += m.Get(r, k) * center[k];
+			e[r] += std::abs(m.Get(r, k)) * extent[k];
+		}
+	}
+	min = c - e;
+	max = c + e;
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(float margin)
+	: root(bvh_null), free_list(bvh_null), proxy_count(0), margin(margin)
+{
+}
+
+void BoundingVolumeHierarchy::Clear()
+{
+	nodes.clear();
+	links.clear();
+	root = free_list = bvh_null;
+	proxy_count = 0;
+}
+
+int BoundingVolumeHierarchy::Allocate()
+{
+	if (free_list == bvh_null) {
+		nodes.emplace_back();
+		links.push_back({ bvh_null, -1 });
+		free_list = int(nodes.size()) - 1;
+	}
+	int id = free_list;
+	free_list = links[id].parent;
+	links[id] = { bvh_null, 0 };
+	nodes[id].child1 = nodes[id].child2 = bvh_null;
+	return id;
+}
+
+void BoundingVolumeHierarchy::Free(int id)
+{
+	links[id] = { free_list, -1 };
+	free_list = id;
+}
+
+int BoundingVolumeHierarchy::Insert(Fvec3 min, Fvec3 max, std::uint32_t value)
+{
+	int leaf = Allocate();
+	Node& node = nodes[leaf];
+	for (int k = 0; k < 3; k++) {
+		node.min[k] = min[k] - margin;
+		node.max[k] = max[k] + margin;
+	}
+	node.child2 = int(value);
+	InsertLeaf(leaf);
+	proxy_count++;
+	return leaf;
+}
+
+void BoundingVolumeHierarchy::Remove(int proxy)
+{
+	RemoveLeaf(proxy);
+	Free(proxy);
+	proxy_count--;
+}
+
+bool BoundingVolumeHierarchy::Move(int proxy, Fvec3 min, Fvec3 max)
+{
+	Node& node = nodes[proxy];
+	bool contained = true;
+	for (int k = 0; k < 3; k++)
+		contained = contained && node.min[k] <= min[k] && max[k] <= node.max[k];
+	if (contained) return false;
+
+	RemoveLeaf(proxy);
+	for (int k = 0; k < 3; k++) {
+		node.min[k] = min[k] - margin;
+		node.max[k] = max[k] + margin;
+	}
+	InsertLeaf(proxy);
+	return true;
+}
+
+std::uint32_t BoundingVolumeHierarchy::GetValue(int proxy) const
+{
+	return std::uint32_t(nodes[proxy].child2);
+}
+
+int BoundingVolumeHierarchy::GetProxyCount() const
+{
+	return proxy_count;
+}
+
+int BoundingVolumeHierarchy::GetHeight() const
+{
+	return root == bvh_null ? 0 : links[root].height;
+}
+
+static float bvh_area(float const* min, float const* max)
+{
+	float x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+	return x * y + y * z + z * x;
+}
+
+// Surface area of the union of two boxes
+static float bvh_union_area(float const* min1, float const* max1, float const* min2, float const* max2)
+{
+	float min[3], max[3];
+	for (int k = 0; k < 3; k++) {
+		min[k] = std::min(min1[k], min2[k]);
+		max[k] = std::max(max1[k], max2[k]);
+	}
+	return bvh_area(min, max);
+}
+
+void BoundingVolumeHierarchy::Refit(int id)
+{
+	Node& node = nodes[id];
+	Node const& a = nodes[node.child1], & b = nodes[node.child2];
+	for (int k = 0; k < 3; k++) {
+		node.min[k] = std::min(a.min[k], b.min[k]);
+		node.max[k] = std::max(a.max[k], b.max[k]);
+	}
+	links[id].height = 1 + std::max(links[node.child1].height, links[node.child2].height);
+}
+
+void BoundingVolumeHierarchy::InsertLeaf(int leaf)
+{
+	if (root == bvh_null) {
+		root = leaf;
+		links[root].parent = bvh_null;
+		return;
+	}
+
+	// descend towards the sibling with the least growth of surface area
+	float const* lmin = nodes[leaf].min, * lmax = nodes[leaf].max;
+	int index = root;
+	while (nodes[index].child1 != bvh_null)
+	{
+		Node const& node = nodes[index];
+		float area = bvh_area(node.min, node.max);
+		float combined = bvh_union_area(node.min, node.max, lmin, lmax);
+		float cost = 2.0f * combined; // pairing with this node
+		float inheritance = 2.0f * (combined - area); // growth pushed down to the children
+
+		auto descend_cost = [&](int child) {
+			Node const& c = nodes[child];
+			float grown = bvh_union_area(c.min, c.max, lmin, lmax);
+			return c.child1 == bvh_null ? grown + inheritance : grown - bvh_area(c.min, c.max) + inheritance;
+		};
+		float cost1 = descend_cost(node.child1), cost2 = descend_cost(node.child2);
+		if (cost < cost1 && cost < cost2) break;
+		index = cost1 < cost2 ? node.child1 : node.child2;
+	}
+
+	int sibling = index;
+	int old_parent = links[sibling].parent;
+	int parent = Allocate();
+	links[parent].parent = old_parent;
+	nodes[parent].child1 = sibling;
+	nodes[parent].child2 = leaf;
+	links[sibling].parent = parent;
+	links[leaf].parent = parent;
+	Refit(parent);
+
+	if (old_parent == bvh_null) root = parent;
+	else if (nodes[old_parent].child1 == sibling) nodes[old_parent].child1 = parent;
+	else nodes[old_parent].child2 = parent;
+
+	for (index = links[parent].parent; index != bvh_null; index = links[index].parent) {
+		index = Balance(index);
+		Refit(index);
+	}
+}
+
+void BoundingVolumeHierarchy::RemoveLeaf(int leaf)
+{
+	if (leaf == root) {
+		root = bvh_null;
+		return;
+	}
+
+	int parent = links[leaf].parent;
+	int grandparent = links[parent].parent;
+	int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+	Free(parent);
+
+	if (grandparent == bvh_null) {
+		root = sibling;
+		links[sibling].parent = bvh_null;
+		return;
+	}
+	if (nodes[grandparent].child1 == parent) nodes[grandparent].child1 = sibling;
+	else nodes[grandparent].child2 = sibling;
+	links[sibling].parent = grandparent;
+
+	for (int index = grandparent; index != bvh_null; index = links[index].parent) {
+		index = Balance(index);
+		Refit(index);
+	}
+}
+
+// Rotate the taller grandchild up when the children of a node differ in height by more than one,
+// returns the node now at the same position
+int BoundingVolumeHierarchy::Balance(int a)
+{
+	Node& A = nodes[a];
+	if (A.child1 == bvh_null || links[a].height < 2) return a;
+
+	int b = A.child1, c = A.child2;
+	int balance = links[c].height - links[b].height;
+	if (balance >= -1 && balance <= 1) return a;
+
+	// the taller child takes the place of a
+	int up = balance > 1 ? c : b;
+	Node& U = nodes[up];
+	int f = U.child1, g = U.child2;
+
+	int parent = links[a].parent;
+	U.child1 = a;
+	links[up].parent = parent;
+	links[a].parent = up;
+	if (parent == bvh_null) root = up;
+	else if (nodes[parent].child1 == a) nodes[parent].child1 = up;
+	else nodes[parent].child2 = up;
+
+	// the taller grandchild stays with up, the other one replaces up under a
+	int keep = links[f].height > links[g].height ? f : g;
+	int give = keep == f ? g : f;
+	U.child2 = keep;
+	links[give].parent = a;
+	if (balance > 1) A.child2 = give;
+	else A.child1 = give;
+
+	Refit(a);
+	Refit(up);
+	return up;
+}
+
+void BoundingVolumeHierarchy::Cull(Frustum const& frustum, std::vector<std::uint32_t>& visible) const
+{
+	if (root == bvh_null) return;
+
+	// the planes in structure of arrays, each node is tested against all of them at once
+	alignas(16) float px[8], py[8], pz[8], pw[8], ax[8], ay[8], az[8];
+	for (int i = 0; i < 8; i++) {
+		Fvec4 const& p = frustum.planes[std::min(i, 5)];
+		px[i] = p[0]; py[i] = p[1]; pz[i] = p[2]; pw[i] = p[3];
+		ax[i] = std::abs(p[0]); ay[i] = std::abs(p[1]); az[i] = std::abs(p[2]);
+	}
+
+	// each entry carries the planes its box is not yet known to be inside of
+	struct Entry { int node; unsigned mask; };
+	std::vector<Entry> stack(std::max(GetHeight() * 2 + 2, 64));
+	int top = 0;
+	auto push = [&](int node, unsigned mask) {
+		if (top == int(stack.size())) stack.resize(stack.size() * 2);
+		stack[top++] = { node, mask };
+	};
+
+	// every leaf below a node entirely inside the frustum is visible
+	auto emit_all = [&](int node) {
+		int base = top;
+		push(node, 0);
+		while (top > base) {
+			Node const& n = nodes[stack[--top].node];
+			if (n.child1 == bvh_null) visible.push_back(std::uint32_t(n.child2));
+			else { push(n.child1, 0); push(n.child2, 0); }
+		}
+	};
+
+	push(root, 0x3F);
+	while (top > 0)
+	{
+		Entry e = stack[--top];
+		Node const& n = nodes[e.node];
+		if (e.mask == 0) { emit_all(e.node); continue; }
+
+		// signed distance of the center and projected radius of the box for each plane
+		unsigned outside, inside;
+#if MAYA_BVH_SSE
+		// the last lane holds a child index, cleared since it would read as a denormal
+		__m128 half = _mm_set1_ps(0.5f), xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+		__m128 bmin = _mm_and_ps(_mm_load_ps(n.min), xyz), bmax = _mm_and_ps(_mm_load_ps(n.max), xyz);
+		__m128 c = _mm_mul_ps(_mm_add_ps(bmin, bmax), half), ext = _mm_mul_ps(_mm_sub_ps(bmax, bmin), half);
+		__m128 cx = _mm_shuffle_ps(c, c, 0x00), cy = _mm_shuffle_ps(c, c, 0x55), cz = _mm_shuffle_ps(c, c, 0xAA);
+		__m128 ex = _mm_shuffle_ps(ext, ext, 0x00), ey = _mm_shuffle_ps(ext, ext, 0x55), ez = _mm_shuffle_ps(ext, ext, 0xAA);
+		outside = inside = 0;
+		for (int i = 0; i < 8; i += 4) {
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(px + i), cx), _mm_mul_ps(_mm_load_ps(py + i), cy)),
+				_mm_add_ps(_mm_mul_ps(_mm_load_ps(pz + i), cz), _mm_load_ps(pw + i)));
+			__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(ax + i), ex), _mm_mul_ps(_mm_load_ps(ay + i), ey)),
+				_mm_mul_ps(_mm_load_ps(az + i), ez));
+			outside |= unsigned(_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(d, r), _mm_setzero_ps()))) << i;
+			inside |= unsigned(_mm_movemask_ps(_mm_cmpge_ps(_mm_sub_ps(d, r), _mm_setzero_ps()))) << i;
+		}
+#else
+		outside = inside = 0;
+		float cx = (n.min[0] + n.max[0]) * 0.5f, cy = (n.min[1] + n.max[1]) * 0.5f, cz = (n.min[2] + n.max[2]) * 0.5f;
+		float ex = (n.max[0] - n.min[0]) * 0.5f, ey = (n.max[1] - n.min[1]) * 0.5f, ez = (n.max[2] - n.min[2]) * 0.5f;
+		for (int i = 0; i < 6; i++) {
+			float d = px[i] * cx + py[i] * cy + pz[i] * cz + pw[i];
+			float r = ax[i] * ex + ay[i] * ey + az[i] * ez;
+			outside |= unsigned(d + r < 0.0f) << i;
+			inside |= unsigned(d - r >= 0.0f) << i;
+		}
+#endif
+		if (outside & e.mask) continue;
+		unsigned mask = e.mask & ~inside;
+		if (n.child1 == bvh_null) visible.push_back(std::uint32_t(n.child2));
+		else if (mask == 0) emit_all(e.node);
+		else { push(n.child1, mask); push(n.child2, mask); }
+	}
+}
+
+}
@@ -0,0 +1,167 @@
+#include "../private_control.hpp"
+#include <Maya3D.hpp>
+
+namespace Maya {
+
+// Every camera state gets a unique revision, so the buffer knows whether it holds it already
+static std::uint64_t next_revision = 1;
+
+static struct Camera_UniformBuffer
+{
+	unsigned int id = 0;
+	std::uint64_t uploaded = 0;
+
+	void Upload(Fmat4 const& projection, Fmat4 const& view, Fmat4 const& view_projection, Fvec3 position)
+	{
+		// std140 with row_major matrices, each matrix is 16 tightly packed floats
+		float data[52];
+		std::memcpy(data, &projection[0], sizeof(float) * 16);
+		std::memcpy(data + 16, &view[0], sizeof(float) * 16);
+		std::memcpy(data + 32, &view_projection[0], sizeof(float) * 16);
+		data[48] = position[0]; data[49] = position[1]; data[50] = position[2]; data[51] = 1.0f;
+
+		if (!id) {
+			glGenBuffers(1, &id);
+			glBindBuffer(GL_UNIFORM_BUFFER, id);
+			glBufferData(GL_UNIFORM_BUFFER, sizeof(data), data, GL_DYNAMIC_DRAW);
+			glBindBufferBase(GL_UNIFORM_BUFFER, Camera::UniformBinding, id);
+		}
+		else {
+			glBindBuffer(GL_UNIFORM_BUFFER, id);
+			glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(data), data);
+		}
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	~Camera_UniformBuffer() {
+		if (id) glDeleteBuffers(1, &id);
+	}
+} uniform_buffer;
+
+Camera::Camera(Fvec3 position, Fvec3 orientation, float fovy, float near, float far)
+	: position(position), orientation(orientation), up(0.0f, 1.0f, 0.0f),
+	  fovy(fovy), near(near), far(far), aspect(1.0f), auto_aspect(true), revision(0), dirty(true)
+{
+	Ivec2 size = GetWindowSize();
+	if (size[0] > 0 && size[1] > 0) aspect = float(size[0]) / size[1];
+}
+
+void Camera::OnEvent(Event const& e)
+{
+	if (auto* resized = EventCast<WindowResizedEvent>(e)) {
+		// minimized windows report a zero size
+		if (auto_aspect && resized->size[0] > 0 && resized->size[1] > 0) {
+			aspect = float(resized->size[0]) / resized->size[1];
+			dirty = true;
+		}
+	}
+}
+
+void Camera::SetPosition(Fvec3 position)
+{
+	this->position = position;
+	dirty = true;
+}
+
+void Camera::SetOrientation(Fvec3 orientation, Fvec3 up)
+{
+	this->orientation = orientation;
+	this->up = up;
+	dirty = true;
+}
+
+void Camera::SetPerspective(float fovy, float near, float far)
+{
+	this->fovy = fovy;
+	this->near = near;
+	this->far = far;
+	dirty = true;
+}
+
+void Camera::SetAspectRatio(float aspect)
+{
+	this->aspect = aspect;
+	auto_aspect = false;
+	dirty = true;
+}
+
+void Camera::SetAspectRatioToViewport()
+{
+	auto_aspect = true;
+	dirty = true;
+}
+
+void Camera::Recompute() const
+{
+	if (auto_aspect) {
+		// the viewport is cached by GLState, so polling it costs no OpenGL call
+		Ivec4 viewport = PrivateControl::Instance().gl.GetViewport();
+		float current = viewport[2] > 0 && viewport[3] > 0 ? float(viewport[2]) / viewport[3] : aspect;
+		if (current != aspect) {
+			aspect = current;
+			dirty = true;
+		}
+	}
+	if (!dirty) return;
+	projection = PerspectiveProjection(fovy, aspect, near, far);
+	view = LookAt(position, orientation, up);
+	view_projection = projection * view;
+	frustum = Frustum(view_projection);
+	revision = next_revision++;
+	dirty = false;
+}
+
+void Camera::Update()
+{
+	Recompute();
+	if (uniform_buffer.uploaded == revision) return;
+	uniform_buffer.Upload(projection, view, view_projection, position);
+	uniform_buffer.uploaded = revision;
+}
+
+Fvec3 Camera::GetPosition() const
+{
+	return position;
+}
+
+Fvec3 Camera::GetOrientation() const
+{
+	return orientation;
+}
+
+float Camera::GetFieldOfView() const
+{
+	return fovy;
+}
+
+float Camera::GetAspectRatio() const
+{
+	Recompute();
+	return aspect;
+}
+
+Fmat4 const& Camera::GetProjection() const
+{
+	Recompute();
+	return projection;
+}
+
+Fmat4 const& Camera::GetView() const
+{
+	Recompute();
+	return view;
+}
+
+Fmat4 const& Camera::GetViewProjection() const
+{
+	Recompute();
+	return view_projection;
+}
+
+Frustum const& Camera::GetFrustum() const
+{
+	Recompute();
+	return frustum;
+}
+
+}
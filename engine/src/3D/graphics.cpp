@@ -61,28 +61,49 @@ static constexpr unsigned int cube_indices[] =
 void Graphics3D::InitResources()
 {
 	Shader* shader = new Shader("engine/res/3D/shaders/default.vert.glsl", "engine/res/3D/shaders/default.frag.glsl");
+	Shader* instanced_shader = new Shader("engine/res/3D/shaders/instanced.vert.glsl", "engine/res/3D/shaders/default.frag.glsl");
 
 	VertexArray* cube_vao = new VertexArray(24);
 	cube_vao->LinkVBO(cube_vertices, VertexLayout(3, 3, 2));
 	cube_vao->LinkIBO(cube_indices, 36);
 
+	shader->BindUniformBlock("Maya_Camera", Camera::UniformBinding);
+	instanced_shader->BindUniformBlock("Maya_Camera", Camera::UniformBinding);
+
 	Assign("Maya_3D_shader_default", shader);
+	Assign("Maya_3D_shader_instanced", instanced_shader);
 	Assign("Maya_3D_vao_cube", cube_vao);
+
+	// sampled by meshes drawn before any SetTexture call
+	std::uint8_t const white[4] = { 255, 255, 255, 255 };
+	Assign("Maya_3D_texture_white", new Texture(white, Ivec2(1), 4));
 }
 
-Graphics3D::Graphics3D() : shader(GetShader("Maya_3D_shader_default"))
+Graphics3D::Graphics3D()
+	: shader(GetShader("Maya_3D_shader_default")), instanced_shader(GetShader("Maya_3D_shader_instanced")),
+	  texture(&GetTexture("Maya_3D_texture_white")), camera(Fvec3(0.0f, -2.0f, -2.0f), Fvec3(0.0f, 1.0f, 1.0f)), lod_tolerance(1.0f)
 {
-	glEnable(GL_DEPTH_TEST);
+	PrivateControl::Instance().gl.SetDepthTest(true);
 	glClear(GL_DEPTH_BUFFER_BIT);
 }
 
+// 3D draws are not hashed, so in RedrawMode::Damaged the frame is drawn as a whole from the first one
+static void draw_untracked()
+{
+	auto& ctrl = PrivateControl::Instance();
+	if (!ctrl.damage.Deferring()) return;
+	for (auto& fn : ctrl.flush_callbacks)
+		fn();
+	ctrl.damage.DrawImmediately();
+}
+
 float rot = 0.0f;
 
 void Graphics3D::DrawCube(float elapsed)
 {
 	rot += elapsed;
-	shader.SetUniform("u_projection", PerspectiveProjection(3.1415926536f / 3, 16.0f / 9, 0.1f, 100.0f));
-	shader.SetUniform("u_view", LookAt(Fvec3(0.0f, -2.0f, -2.0f), Fvec3(0.0f, 1.0f, 1.0f)));
+	draw_untracked();
+	camera.Update();
 	shader.SetUniform("u_model", Rotate(rot, up));
 
 	GetTexture("Maya").Bind(0);
@@ -91,4 +112,84 @@ void Graphics3D::DrawCube(float elapsed)
 	shader.Draw("Maya_3D_vao_cube");
 }
 
+Camera& Graphics3D::GetCamera()
+{
+	return camera;
+}
+
+void Graphics3D::SetTexture(Texture& texture)
+{
+	this->texture = &texture;
+}
+
+void Graphics3D::SetLodTolerance(float pixels)
+{
+	lod_tolerance = pixels;
+}
+
+float Graphics3D::GetScreenSize(Mesh const& mesh, Fmat4 const& model) const
+{
+	// the sphere grows with the longest axis of the model matrix
+	float scale = 0.0f;
+	for (int c = 0; c < 3; c++)
+		scale = std::max(scale, Fvec3(model.Get(0, c), model.Get(1, c), model.Get(2, c)).Norm());
+	Fvec3 center = mesh.GetCenter();
+	Fvec4 world = model * Fvec4(center[0], center[1], center[2], 1.0f);
+	float radius = mesh.GetRadius() * scale;
+	float distance = (Fvec3(world[0], world[1], world[2]) - camera.GetPosition()).Norm();
+	if (distance <= radius) return std::numeric_limits<float>::max();
+
+	float height = float(PrivateControl::Instance().gl.GetViewport()[3]);
+	return radius / (distance * std::tan(camera.GetFieldOfView() / 2.0f)) * height;
+}
+
+void Graphics3D::DrawMesh(Mesh& mesh, Fmat4 const& model, int* lod)
+{
+	draw_untracked();
+	camera.Update();
+	int level = mesh.SelectLod(GetScreenSize(mesh, model), lod ? *lod : -1, lod_tolerance);
+	if (lod) *lod = level;
+
+	texture->Bind(0);
+	shader.SetUniform("u_texture", 0);
+	shader.SetUniform("u_model", model);
+	mesh.Draw(level);
+}
+
+void Graphics3D::DrawInstanced(Mesh& mesh, std::span<Fmat4 const> models, std::span<std::uint8_t> lods)
+{
+	if (models.empty()) return;
+	draw_untracked();
+	camera.Update();
+
+	texture->Bind(0);
+	instanced_shader.SetUniform("u_texture", 0);
+	instanced_shader.Bind();
+
+	int levels = mesh.GetLodCount();
+	if (levels == 1) {
+		mesh.DrawInstanced(models);
+		return;
+	}
+
+	// instances are grouped by level with a counting sort, then every group is one draw call
+	bool stateful = lods.size() == models.size();
+	std::vector<std::uint8_t> selected(models.size());
+	std::vector<std::size_t> offsets(levels + 1, 0);
+	for (std::size_t i = 0; i < models.size(); i++) {
+		int current = stateful && lods[i] < levels ? lods[i] : -1;
+		selected[i] = std::uint8_t(mesh.SelectLod(GetScreenSize(mesh, models[i]), current, lod_tolerance));
+		if (stateful) lods[i] = selected[i];
+		offsets[selected[i] + 1]++;
+	}
+	for (int l = 0; l < levels; l++) offsets[l + 1] += offsets[l];
+
+	sorted_models.resize(models.size());
+	std::vector<std::size_t> fill(offsets.begin(), offsets.end() - 1);
+	for (std::size_t i = 0; i < models.size(); i++) sorted_models[fill[selected[i]]++] = models[i];
+	for (int l = 0; l < levels; l++)
+		if (offsets[l + 1] > offsets[l])
+			mesh.DrawInstanced(std::span<Fmat4 const>(sorted_models.data() + offsets[l], offsets[l + 1] - offsets[l]), l);
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,722 @@
+#include "../private_control.hpp"
+#include <Maya3D.hpp>
+#include <fstream>
+#include <charconv>
+#include <thread>
+#include <atomic>
+
+namespace Maya {
+
+constexpr static int mesh_stride = 8;
+
+// A coarser level of detail has to fit within this fraction below the tolerance before it is taken
+constexpr static float lod_hysteresis = 0.25f;
+
+// Run fn(i) for every i in [0, count) on as many threads as the hardware offers
+static void parallel_for(int count, std::function<void(int)> const& fn)
+{
+	int workers = std::min(count, std::max(int(std::thread::hardware_concurrency()), 1));
+	if (workers <= 1) {
+		for (int i = 0; i < count; i++) fn(i);
+		return;
+	}
+	std::atomic<int> next = 0;
+	std::vector<std::thread> threads;
+	threads.reserve(workers);
+	for (int w = 0; w < workers; w++)
+		threads.emplace_back([&]() { for (int i; (i = next++) < count;) fn(i); });
+	for (auto& t : threads) t.join();
+}
+
+static bool read_file(std::string const& path, std::vector<char>& out)
+{
+	std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+	if (!ifs.is_open()) return false;
+	out.resize(std::size_t(ifs.tellg()));
+	ifs.seekg(0);
+	ifs.read(out.data(), out.size());
+	return bool(ifs);
+}
+
+// Merges identical vertices with an open addressing table keyed by a hash of their floats
+class VertexDeduplicator
+{
+public:
+	VertexDeduplicator(MeshData& data, std::size_t expected)
+		: data(data), slots(std::bit_ceil(std::max<std::size_t>(expected * 2, 16)), ~0u)
+	{
+		data.vertices.reserve(expected * mesh_stride);
+	}
+
+	unsigned int Insert(float const* vertex)
+	{
+		std::uint64_t h = HashBytes(vertex, sizeof(float) * mesh_stride);
+		std::size_t mask = slots.size() - 1;
+		for (std::size_t i = h & mask;; i = (i + 1) & mask)
+		{
+			unsigned int& slot = slots[i];
+			if (slot == ~0u) {
+				slot = unsigned(data.vertices.size() / mesh_stride);
+				data.vertices.insert(data.vertices.end(), vertex, vertex + mesh_stride);
+				if (data.vertices.size() / mesh_stride * 2 > slots.size()) Grow();
+				return slot;
+			}
+			if (std::memcmp(&data.vertices[std::size_t(slot) * mesh_stride], vertex, sizeof(float) * mesh_stride) == 0)
+				return slot;
+		}
+	}
+
+private:
+	MeshData& data;
+	std::vector<unsigned int> slots;
+
+	void Grow()
+	{
+		std::vector<unsigned int> old(slots.size() * 2, ~0u);
+		old.swap(slots);
+		std::size_t mask = slots.size() - 1;
+		for (unsigned int v : old) {
+			if (v == ~0u) continue;
+			std::size_t i = HashBytes(&data.vertices[std::size_t(v) * mesh_stride], sizeof(float) * mesh_stride) & mask;
+			while (slots[i] != ~0u) i = (i + 1) & mask;
+			slots[i] = v;
+		}
+	}
+};
+
+// Area weighted normals for the vertices whose normal is zero
+static void generate_normals(MeshData& data, std::size_t first_vertex, std::size_t first_index)
+{
+	std::vector<bool> missing(data.vertices.size() / mesh_stride - first_vertex);
+	bool any = false;
+	for (std::size_t v = 0; v < missing.size(); v++) {
+		float const* n = &data.vertices[(first_vertex + v) * mesh_stride + 3];
+		missing[v] = n[0] == 0.0f && n[1] == 0.0f && n[2] == 0.0f;
+		any = any || missing[v];
+	}
+	if (!any) return;
+
+	for (std::size_t i = first_index; i + 2 < data.indices.size(); i += 3)
+	{
+		float* p[3];
+		for (int k = 0; k < 3; k++) p[k] = &data.vertices[std::size_t(data.indices[i + k]) * mesh_stride];
+		Fvec3 a(p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2]);
+		Fvec3 b(p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2]);
+		Fvec3 n = Cross(a, b);
+		for (int k = 0; k < 3; k++) {
+			if (!missing[data.indices[i + k] - first_vertex]) continue;
+			p[k][3] += n[0]; p[k][4] += n[1]; p[k][5] += n[2];
+		}
+	}
+	for (std::size_t v = 0; v < missing.size(); v++) {
+		if (!missing[v]) continue;
+		float* n = &data.vertices[(first_vertex + v) * mesh_stride + 3];
+		float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length > 0.0f) { n[0] /= length; n[1] /= length; n[2] /= length; }
+	}
+}
+
+static void compute_bounds(MeshData& data)
+{
+	data.min = Fvec3(0.0f);
+	data.max = Fvec3(0.0f);
+	if (data.vertices.empty()) return;
+	data.min = data.max = Fvec3(data.vertices[0], data.vertices[1], data.vertices[2]);
+	for (std::size_t i = 0; i < data.vertices.size(); i += mesh_stride)
+		for (int k = 0; k < 3; k++) {
+			data.min[k] = std::min(data.min[k], data.vertices[i + k]);
+			data.max[k] = std::max(data.max[k], data.vertices[i + k]);
+		}
+}
+
+//---------------------------------------------------------------------------
+// Wavefront OBJ
+
+// Files are cut into chunks of about this many bytes, parsed in parallel
+constexpr static std::size_t obj_chunk_bytes = 1 << 20;
+
+// An index of a face corner, 0 based. Relative (negative) indices count back from the attributes
+// parsed so far, which a chunk only knows within itself, so they are kept as an offset from the
+// start of the chunk and rebased once the counts of earlier chunks are known. The offset is
+// negative when the index reaches into an earlier chunk.
+struct ObjIndex
+{
+	int value;
+	bool relative;
+};
+
+constexpr static ObjIndex obj_absent = { INT_MIN, false };
+
+// Attributes and triangulated faces of a range of lines
+struct ObjChunk
+{
+	std::vector<float> positions, normals, uvs;
+	std::vector<ObjIndex> corners; // position, uv and normal index of every triangle corner
+};
+
+static char const* obj_skip(char const* p, char const* end)
+{
+	while (p < end && (*p == ' ' || *p == '\t')) p++;
+	return p;
+}
+
+static char const* obj_floats(char const* p, char const* end, int count, std::vector<float>& out)
+{
+	for (int i = 0; i < count; i++) {
+		p = obj_skip(p, end);
+		float value = 0.0f;
+		auto result = std::from_chars(p, end, value);
+		p = result.ptr;
+		out.push_back(value);
+	}
+	return p;
+}
+
+static void obj_parse(char const* p, char const* end, ObjChunk& chunk)
+{
+	std::vector<ObjIndex> face;
+	while (p < end)
+	{
+		char const* eol = static_cast<char const*>(std::memchr(p, '\n', end - p));
+		if (!eol) eol = end;
+		p = obj_skip(p, eol);
+
+		if (eol - p > 2 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+			obj_floats(p + 2, eol, 3, chunk.positions);
+		else if (eol - p > 3 && p[0] == 'v' && p[1] == 'n')
+			obj_floats(p + 2, eol, 3, chunk.normals);
+		else if (eol - p > 3 && p[0] == 'v' && p[1] == 't')
+			obj_floats(p + 2, eol, 2, chunk.uvs);
+		else if (eol - p > 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+		{
+			int const counts[3] = { int(chunk.positions.size() / 3), int(chunk.uvs.size() / 2), int(chunk.normals.size() / 3) };
+			face.clear();
+			for (char const* q = obj_skip(p + 2, eol); q < eol && *q != '\r'; q = obj_skip(q, eol))
+			{
+				// v, v/vt, v//vn or v/vt/vn
+				for (int k = 0; k < 3; k++) {
+					int index = 0;
+					auto result = std::from_chars(q, eol, index);
+					q = result.ptr;
+					if (index > 0) face.push_back({ index - 1, false });
+					else if (index < 0) face.push_back({ counts[k] + index, true });
+					else face.push_back(obj_absent);
+					if (q < eol && *q == '/') q++;
+					else { for (k++; k < 3; k++) face.push_back(obj_absent); }
+				}
+				while (q < eol && *q != ' ' && *q != '\t' && *q != '\r') q++;
+			}
+			// polygons are split into a fan
+			for (std::size_t i = 2; i < face.size() / 3; i++) {
+				chunk.corners.insert(chunk.corners.end(), face.begin(), face.begin() + 3);
+				chunk.corners.insert(chunk.corners.end(), face.begin() + (i - 1) * 3, face.begin() + (i + 1) * 3);
+			}
+		}
+		p = eol + 1;
+	}
+}
+
+static bool load_obj(std::vector<char> const& file, MeshData& data)
+{
+	// lines are split into chunks cut at line breaks, shared among the worker threads
+	int count = int(std::max<std::size_t>(file.size() / obj_chunk_bytes, 1));
+	std::vector<char const*> cuts(count + 1);
+	char const* begin = file.data(), * end = begin + file.size();
+	cuts[0] = begin;
+	cuts[count] = end;
+	for (int i = 1; i < count; i++) {
+		char const* p = begin + file.size() * i / count;
+		p = static_cast<char const*>(std::memchr(p, '\n', end - p));
+		cuts[i] = std::max(p ? p + 1 : end, cuts[i - 1]);
+	}
+
+	std::vector<ObjChunk> chunks(count);
+	parallel_for(count, [&](int i) { obj_parse(cuts[i], cuts[i + 1], chunks[i]); });
+
+	std::vector<float> positions, normals, uvs;
+	std::size_t corners = 0;
+	for (auto const& c : chunks) corners += c.corners.size() / 3;
+
+	std::vector<int> resolved;
+	resolved.reserve(corners * 3);
+	for (auto& c : chunks) {
+		// attributes parsed by every earlier chunk
+		int const offsets[3] = { int(positions.size() / 3), int(uvs.size() / 2), int(normals.size() / 3) };
+		for (std::size_t i = 0; i < c.corners.size(); i++) {
+			ObjIndex index = c.corners[i];
+			resolved.push_back(index.relative ? index.value + offsets[i % 3] : index.value);
+		}
+		positions.insert(positions.end(), c.positions.begin(), c.positions.end());
+		uvs.insert(uvs.end(), c.uvs.begin(), c.uvs.end());
+		normals.insert(normals.end(), c.normals.begin(), c.normals.end());
+		c = ObjChunk{};
+	}
+
+	VertexDeduplicator dedup(data, corners);
+	data.indices.reserve(corners);
+	for (std::size_t i = 0; i < resolved.size(); i += 3)
+	{
+		int p = resolved[i], t = resolved[i + 1], n = resolved[i + 2];
+		if (p < 0 || std::size_t(p) * 3 >= positions.size()) {
+#if MAYA_DEBUG
+			std::cout << "OBJ face refers to a missing vertex\n";
+#endif
+			return false;
+		}
+		float vertex[mesh_stride] = { positions[p * 3], positions[p * 3 + 1], positions[p * 3 + 2] };
+		if (n >= 0 && std::size_t(n) * 3 < normals.size())
+			std::copy_n(&normals[n * 3], 3, vertex + 3);
+		if (t >= 0 && std::size_t(t) * 2 < uvs.size())
+			std::copy_n(&uvs[t * 2], 2, vertex + 6);
+		data.indices.push_back(dedup.Insert(vertex));
+	}
+	generate_normals(data, 0, 0);
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// Binary glTF
+
+// Just enough JSON for the glTF header
+struct Json
+{
+	enum Type { Null, Bool, Number, String, Array, Object } type = Null;
+	double number = 0;
+	std::string string;
+	std::vector<Json> array;
+	std::vector<std::pair<std::string, Json>> object;
+
+	Json const& operator[](std::string_view key) const
+	{
+		for (auto const& [k, v] : object)
+			if (k == key) return v;
+		return null;
+	}
+
+	Json const& operator[](std::size_t i) const { return i < array.size() ? array[i] : null; }
+	std::size_t Size() const { return type == Array ? array.size() : 0; }
+	int Int(int fallback = -1) const { return type == Number ? int(number) : fallback; }
+	float Float(float fallback) const { return type == Number ? float(number) : fallback; }
+
+	static Json const null;
+};
+
+Json const Json::null = {};
+
+static void json_space(char const*& p, char const* end)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+}
+
+static bool json_parse(char const*& p, char const* end, Json& out, int depth = 0)
+{
+	json_space(p, end);
+	if (p >= end || depth > 64) return false;
+	if (*p == '{' || *p == '[')
+	{
+		bool object = *p++ == '{';
+		out.type = object ? Json::Object : Json::Array;
+		json_space(p, end);
+		if (p < end && *p == (object ? '}' : ']')) { p++; return true; }
+		while (p < end)
+		{
+			Json value;
+			if (object) {
+				Json key;
+				if (!json_parse(p, end, key, depth + 1) || key.type != Json::String) return false;
+				json_space(p, end);
+				if (p >= end || *p++ != ':') return false;
+				if (!json_parse(p, end, value, depth + 1)) return false;
+				out.object.emplace_back(std::move(key.string), std::move(value));
+			}
+			else {
+				if (!json_parse(p, end, value, depth + 1)) return false;
+				out.array.push_back(std::move(value));
+			}
+			json_space(p, end);
+			if (p < end && *p == ',') { p++; continue; }
+			if (p < end && *p == (object ? '}' : ']')) { p++; return true; }
+			return false;
+		}
+		return false;
+	}
+	if (*p == '"')
+	{
+		// escapes are kept as they are, names used by glTF never contain any
+		out.type = Json::String;
+		char const* s = ++p;
+		while (p < end && *p != '"') p += *p == '\\' ? 2 : 1;
+		if (p >= end) return false;
+		out.string.assign(s, p++);
+		return true;
+	}
+	if (end - p >= 4 && std::memcmp(p, "true", 4) == 0) { out.type = Json::Bool; out.number = 1; p += 4; return true; }
+	if (end - p >= 5 && std::memcmp(p, "false", 5) == 0) { out.type = Json::Bool; p += 5; return true; }
+	if (end - p >= 4 && std::memcmp(p, "null", 4) == 0) { p += 4; return true; }
+
+	out.type = Json::Number;
+	auto result = std::from_chars(p, end, out.number);
+	if (result.ec != std::errc()) return false;
+	p = result.ptr;
+	return true;
+}
+
+struct GlbFile
+{
+	Json json;
+	std::uint8_t const* bin = nullptr;
+	std::size_t bin_size = 0;
+
+	// Read an accessor as floats, normalized integers are mapped to [0, 1]
+	bool ReadFloats(int index, int components, std::vector<float>& out) const
+	{
+		Json const& accessor = json["accessors"][index];
+		Json const& view = json["bufferViews"][accessor["bufferView"].Int()];
+		if (view.type == Json::Null || view["buffer"].Int(0) != 0) return false;
+
+		int type = accessor["componentType"].Int();
+		int size = type == 5126 ? 4 : type == 5123 ? 2 : type == 5121 ? 1 : 0;
+		std::size_t count = accessor["count"].Int(0);
+		std::size_t stride = view["byteStride"].Int(size * components);
+		std::size_t offset = std::size_t(view["byteOffset"].Int(0)) + accessor["byteOffset"].Int(0);
+		if (!size || (count && offset + stride * (count - 1) + size * components > bin_size)) return false;
+
+		out.resize(count * components);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			std::uint8_t const* src = bin + offset + stride * i;
+			for (int k = 0; k < components; k++) {
+				float& value = out[i * components + k];
+				if (type == 5126) std::memcpy(&value, src + k * 4, 4);
+				else if (type == 5123) { std::uint16_t v; std::memcpy(&v, src + k * 2, 2); value = v / 65535.0f; }
+				else value = src[k] / 255.0f;
+			}
+		}
+		return true;
+	}
+
+	bool ReadIndices(int index, std::vector<unsigned int>& out) const
+	{
+		Json const& accessor = json["accessors"][index];
+		Json const& view = json["bufferViews"][accessor["bufferView"].Int()];
+		if (view.type == Json::Null || view["buffer"].Int(0) != 0) return false;
+
+		int type = accessor["componentType"].Int();
+		int size = type == 5125 ? 4 : type == 5123 ? 2 : type == 5121 ? 1 : 0;
+		std::size_t count = accessor["count"].Int(0);
+		std::size_t offset = std::size_t(view["byteOffset"].Int(0)) + accessor["byteOffset"].Int(0);
+		if (!size || offset + count * size > bin_size) return false;
+
+		out.resize(count);
+		for (std::size_t i = 0; i < count; i++) {
+			std::uint8_t const* src = bin + offset + i * size;
+			if (size == 4) std::memcpy(&out[i], src, 4);
+			else if (size == 2) { std::uint16_t v; std::memcpy(&v, src, 2); out[i] = v; }
+			else out[i] = src[0];
+		}
+		return true;
+	}
+};
+
+// Local transform of a node, either a matrix or translation, rotation and scale
+static Fmat4 glb_node_transform(Json const& node)
+{
+	Fmat4 m(1.0f);
+	if (node["matrix"].Size() == 16) {
+		// stored column by column
+		for (int i = 0; i < 16; i++) m.Get(i % 4, i / 4) = node["matrix"][i].Float(0.0f);
+		return m;
+	}
+	Json const& t = node["translation"], & r = node["rotation"], & s = node["scale"];
+	float x = r[0].Float(0.0f), y = r[1].Float(0.0f), z = r[2].Float(0.0f), w = r[3].Float(1.0f);
+	Fmat4 rotation(
+		1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w), 0.0f,
+		2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w), 0.0f,
+		2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y), 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+	return Translate(Fvec3(t[0].Float(0.0f), t[1].Float(0.0f), t[2].Float(0.0f)))
+		* rotation * Scale(Fvec3(s[0].Float(1.0f), s[1].Float(1.0f), s[2].Float(1.0f)));
+}
+
+static bool load_glb(std::vector<char> const& file, MeshData& data)
+{
+	auto u32 = [&](std::size_t offset) { std::uint32_t v; std::memcpy(&v, file.data() + offset, 4); return v; };
+	if (file.size() < 20 || u32(0) != 0x46546C67 || u32(4) != 2) {
+#if MAYA_DEBUG
+		std::cout << "Only binary glTF 2.0 files are supported\n";
+#endif
+		return false;
+	}
+
+	// the JSON chunk comes first, followed by an optional binary chunk
+	GlbFile glb;
+	std::size_t json_length = u32(12);
+	if (u32(16) != 0x4E4F534A || 20 + json_length > file.size()) return false;
+	char const* p = file.data() + 20;
+	if (!json_parse(p, p + json_length, glb.json)) return false;
+	std::size_t bin_offset = 20 + ((json_length + 3) & ~std::size_t(3));
+	if (bin_offset + 8 <= file.size() && u32(bin_offset + 4) == 0x004E4942) {
+		glb.bin = reinterpret_cast<std::uint8_t const*>(file.data()) + bin_offset + 8;
+		glb.bin_size = std::min<std::size_t>(u32(bin_offset), file.size() - bin_offset - 8);
+	}
+
+	// every mesh instance of the default scene, with the transform of its node
+	struct Instance { int mesh; Fmat4 transform; };
+	std::vector<Instance> instances;
+	Json const& nodes = glb.json["nodes"];
+	std::function<void(int, Fmat4 const&, int)> visit = [&](int index, Fmat4 const& parent, int depth) {
+		Json const& node = nodes[index];
+		if (node.type == Json::Null || depth > 64) return;
+		Fmat4 transform = parent * glb_node_transform(node);
+		if (node["mesh"].Int() >= 0) instances.push_back({ node["mesh"].Int(), transform });
+		for (auto const& child : node["children"].array) visit(child.Int(), transform, depth + 1);
+	};
+	Json const& scenes = glb.json["scenes"];
+	if (scenes.Size()) {
+		for (auto const& root : scenes[glb.json["scene"].Int(0)]["nodes"].array) visit(root.Int(), Fmat4(1.0f), 0);
+	}
+	else {
+		for (std::size_t i = 0; i < glb.json["meshes"].Size(); i++) instances.push_back({ int(i), Fmat4(1.0f) });
+	}
+
+	struct Part { int mesh, primitive; Fmat4 const* transform; MeshData data; bool ok = true; };
+	std::vector<Part> parts;
+	for (auto const& instance : instances)
+		for (std::size_t i = 0; i < glb.json["meshes"][instance.mesh]["primitives"].Size(); i++)
+			parts.push_back({ instance.mesh, int(i), &instance.transform, {} });
+
+	parallel_for(int(parts.size()), [&](int i) {
+		Part& part = parts[i];
+		Json const& primitive = glb.json["meshes"][part.mesh]["primitives"][part.primitive];
+		if (primitive["mode"].Int(4) != 4) return; // triangles only
+		Json const& attributes = primitive["attributes"];
+
+		std::vector<float> positions, normals, uvs;
+		if (!glb.ReadFloats(attributes["POSITION"].Int(), 3, positions)) { part.ok = false; return; }
+		std::size_t count = positions.size() / 3;
+		if (attributes["NORMAL"].type != Json::Null && !glb.ReadFloats(attributes["NORMAL"].Int(), 3, normals)) normals.clear();
+		if (attributes["TEXCOORD_0"].type != Json::Null && !glb.ReadFloats(attributes["TEXCOORD_0"].Int(), 2, uvs)) uvs.clear();
+
+		std::vector<unsigned int> indices;
+		if (primitive["indices"].type != Json::Null) {
+			if (!glb.ReadIndices(primitive["indices"].Int(), indices)) { part.ok = false; return; }
+		}
+		else {
+			indices.resize(count);
+			for (std::size_t k = 0; k < count; k++) indices[k] = unsigned(k);
+		}
+
+		// normals go through the rows of the inverse transpose, which the cofactors are proportional to
+		Fmat4 const& m = *part.transform;
+		auto cofactor = [&](int r, int c) {
+			int r0 = (r + 1) % 3, r1 = (r + 2) % 3, c0 = (c + 1) % 3, c1 = (c + 2) % 3;
+			return m.Get(r0, c0) * m.Get(r1, c1) - m.Get(r0, c1) * m.Get(r1, c0);
+		};
+		float normal_matrix[3][3];
+		for (int r = 0; r < 3; r++) for (int c = 0; c < 3; c++) normal_matrix[r][c] = cofactor(r, c);
+
+		VertexDeduplicator dedup(part.data, count);
+		std::vector<unsigned int> remap(count);
+		for (std::size_t v = 0; v < count; v++)
+		{
+			float vertex[mesh_stride] = {};
+			Fvec4 pos = m * Fvec4(positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2], 1.0f);
+			vertex[0] = pos[0]; vertex[1] = pos[1]; vertex[2] = pos[2];
+			if (normals.size() == count * 3) {
+				float const* n = &normals[v * 3];
+				float length = 0.0f;
+				for (int r = 0; r < 3; r++) {
+					vertex[3 + r] = normal_matrix[r][0] * n[0] + normal_matrix[r][1] * n[1] + normal_matrix[r][2] * n[2];
+					length += vertex[3 + r] * vertex[3 + r];
+				}
+				if (length > 0.0f) for (int r = 0; r < 3; r++) vertex[3 + r] /= std::sqrt(length);
+			}
+			if (uvs.size() == count * 2) {
+				// glTF puts the origin of texture coordinates at the top left
+				vertex[6] = uvs[v * 2];
+				vertex[7] = 1.0f - uvs[v * 2 + 1];
+			}
+			remap[v] = dedup.Insert(vertex);
+		}
+		part.data.indices.reserve(indices.size());
+		for (unsigned int index : indices) {
+			if (index >= count) { part.ok = false; return; }
+			part.data.indices.push_back(remap[index]);
+		}
+		generate_normals(part.data, 0, 0);
+	});
+
+	std::size_t vertices = 0, indices = 0;
+	for (auto const& part : parts) {
+		if (!part.ok) return false;
+		vertices += part.data.vertices.size();
+		indices += part.data.indices.size();
+	}
+	data.vertices.reserve(vertices);
+	data.indices.reserve(indices);
+	for (auto& part : parts) {
+		unsigned int base = unsigned(data.vertices.size() / mesh_stride);
+		data.vertices.insert(data.vertices.end(), part.data.vertices.begin(), part.data.vertices.end());
+		for (unsigned int index : part.data.indices) data.indices.push_back(base + index);
+		part.data = MeshData{};
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool Mesh::Load(std::string const& path, MeshData& data, bool lods)
+{
+	data = MeshData{};
+	std::vector<char> file;
+	if (!read_file(path, file)) {
+#if MAYA_DEBUG
+		std::cout << "Cannot open mesh file \"" << path << "\"\n";
+#endif
+		return false;
+	}
+
+	std::string extension = path.substr(std::min(path.find_last_of('.'), path.size()));
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return char(std::tolower(c)); });
+	bool ok = false;
+	if (extension == ".obj") ok = load_obj(file, data);
+	else if (extension == ".glb") ok = load_glb(file, data);
+#if MAYA_DEBUG
+	else std::cout << "Unsupported mesh format \"" << extension << "\", expects .obj or .glb\n";
+	if (!ok) std::cout << "Failed to load mesh \"" << path << "\"\n";
+#endif
+	if (!ok) data = MeshData{};
+	compute_bounds(data);
+	if (ok && lods) GenerateLods(data);
+	return ok;
+}
+
+std::future<MeshData> Mesh::LoadAsync(std::string const& path, bool lods)
+{
+	return std::async(std::launch::async, [path, lods]() {
+		MeshData data;
+		Load(path, data, lods);
+		return data;
+	});
+}
+
+static MeshData load_or_empty(std::string const& path)
+{
+	MeshData data;
+	Mesh::Load(path, data);
+	return data;
+}
+
+Mesh::Mesh(std::string const& path)
+	: Mesh(load_or_empty(path))
+{
+}
+
+Mesh::Mesh(MeshData const& data)
+	: vao(nullptr), vertex_count(int(data.vertices.size() / mesh_stride)), lods(data.lods), min(data.min), max(data.max)
+{
+	if (lods.empty()) lods.push_back({ 0, unsigned(data.indices.size()), 0.0f });
+	if (data.indices.empty()) return;
+	// per instance model matrices, the buffer grows on demand
+	VertexLayout instances(4, 4, 4, 4);
+	instances.location = 3;
+	instances.divisor = 1;
+	instances.count = 1;
+	VertexDataStruct vds = {
+		{ const_cast<float*>(data.vertices.data()), VertexLayout(3, 3, 2) },
+		{ nullptr, instances }
+	};
+	vao = new VertexArray(vds, vertex_count, Primitives::Triangles, const_cast<unsigned int*>(data.indices.data()), unsigned(data.indices.size()));
+}
+
+Mesh::~Mesh()
+{
+	if (!vao) return;
+	vao->Release();
+	delete vao;
+}
+
+void Mesh::Draw(int lod)
+{
+	if (vao) vao->DrawElements(lods[lod].first, lods[lod].count);
+}
+
+void Mesh::DrawInstanced(std::span<Fmat4 const> models, int lod)
+{
+	static_assert(sizeof(Fmat4) == sizeof(float) * 16);
+	if (!vao || models.empty()) return;
+	vao->UpdateVBO(1, &models[0][0], int(models.size()));
+	vao->DrawElementsInstanced(lods[lod].first, lods[lod].count, int(models.size()));
+}
+
+int Mesh::SelectLod(float screen_size, int current, float tolerance) const
+{
+	// error of a level on screen, the diameter of the sphere spans screen_size pixels
+	float scale = screen_size / std::max(GetRadius() * 2.0f, 1e-6f);
+	auto fits = [&](int lod, float threshold) { return lods[lod].error * scale <= threshold; };
+
+	int last = int(lods.size()) - 1;
+	if (current < 0 || current > last || !fits(current, tolerance)) {
+		// the coarsest level that still fits, finer than current if it is too coarse
+		int lod = 0;
+		while (lod < last && fits(lod + 1, tolerance)) lod++;
+		return lod;
+	}
+
+	int lod = current;
+	while (lod < last && fits(lod + 1, tolerance * (1.0f - lod_hysteresis))) lod++;
+	return lod;
+}
+
+VertexArray& Mesh::GetVertexArray() const
+{
+#if MAYA_DEBUG
+	if (!vao) {
+		std::cout << "Attempting to call Mesh::GetVertexArray on an empty mesh\n";
+		throw 0;
+	}
+#endif
+	return *vao;
+}
+
+int Mesh::GetVertexCount() const
+{
+	return vertex_count;
+}
+
+int Mesh::GetIndexCount(int lod) const
+{
+	return int(lods[lod].count);
+}
+
+int Mesh::GetLodCount() const
+{
+	return int(lods.size());
+}
+
+MeshLod const& Mesh::GetLod(int lod) const
+{
+	return lods[lod];
+}
+
+Fvec3 Mesh::GetBoundsMin() const
+{
+	return min;
+}
+
+Fvec3 Mesh::GetBoundsMax() const
+{
+	return max;
+}
+
+Fvec3 Mesh::GetCenter() const
+{
+	return (min + max) / 2.0f;
+}
+
+float Mesh::GetRadius() const
+{
+	return (max - min).Norm() / 2.0f;
+}
+
+}
@@ -0,0 +1,277 @@
+#include "../private_control.hpp"
+#include <Maya3D.hpp>
+#include <queue>
+
+namespace Maya {
+
+constexpr static int simplify_stride = 8;
+
+// Boundary edges are held in place by planes perpendicular to their faces, weighted by this
+constexpr static double simplify_border_weight = 10.0;
+
+// A collapse is rejected if it turns a triangle by more than about 75 degrees
+constexpr static double simplify_max_turn = 0.25;
+
+// Errors of a level are measured against the previous one, so they add up along the chain.
+// Levels stop once a level would have fewer triangles than this, or barely fewer than the previous one
+constexpr static std::size_t lod_min_triangles = 32;
+constexpr static float lod_min_reduction = 0.9f;
+
+// Symmetric 4x4 matrix summing the squared distances to a set of planes (Garland and Heckbert)
+struct Quadric
+{
+	double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+	void AddPlane(double a, double b, double c, double d, double w)
+	{
+		a2 += w * a * a; ab += w * a * b; ac += w * a * c; ad += w * a * d;
+		b2 += w * b * b; bc += w * b * c; bd += w * b * d;
+		c2 += w * c * c; cd += w * c * d; d2 += w * d * d;
+	}
+
+	Quadric& operator+=(Quadric const& q)
+	{
+		a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2;
+		bc += q.bc; bd += q.bd; c2 += q.c2; cd += q.cd; d2 += q.d2;
+		return *this;
+	}
+
+	double Error(float const* p) const
+	{
+		double x = p[0], y = p[1], z = p[2];
+		double e = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+			+ b2 * y * y + 2 * bc * y * z + 2 * bd * y + c2 * z * z + 2 * cd * z + d2;
+		return std::max(e, 0.0);
+	}
+};
+
+static void simplify_cross(float const* a, float const* b, float const* c, double* n)
+{
+	double u[3] = { double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2] };
+	double v[3] = { double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2] };
+	n[0] = u[1] * v[2] - u[2] * v[1];
+	n[1] = u[2] * v[0] - u[0] * v[2];
+	n[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+std::vector<unsigned int> SimplifyMesh(MeshData const& data, std::span<unsigned int const> indices,
+	std::size_t target_index_count, float* error)
+{
+	if (error) *error = 0.0f;
+	std::size_t vertex_count = data.vertices.size() / simplify_stride;
+	auto position = [&](unsigned int vertex) { return &data.vertices[std::size_t(vertex) * simplify_stride]; };
+
+	// vertices split by normals or texture coordinates are welded by position
+	std::vector<unsigned int> weld(vertex_count);
+	std::vector<unsigned int> representative;
+	{
+		std::unordered_map<std::uint64_t, std::vector<unsigned int>> table;
+		table.reserve(vertex_count);
+		for (unsigned int v = 0; v < vertex_count; v++) {
+			auto& bucket = table[HashBytes(position(v), sizeof(float) * 3)];
+			unsigned int found = ~0u;
+			for (unsigned int p : bucket)
+				if (std::memcmp(position(representative[p]), position(v), sizeof(float) * 3) == 0) { found = p; break; }
+			if (found == ~0u) {
+				found = unsigned(representative.size());
+				representative.push_back(v);
+				bucket.push_back(found);
+			}
+			weld[v] = found;
+		}
+	}
+	std::size_t count = representative.size();
+	auto point = [&](unsigned int p) { return position(representative[p]); };
+
+	// vertices sharing each position, to pick attributes once positions move
+	std::vector<unsigned int> wedge_offsets(count + 1, 0), wedges(vertex_count);
+	for (unsigned int v = 0; v < vertex_count; v++) wedge_offsets[weld[v] + 1]++;
+	for (std::size_t p = 0; p < count; p++) wedge_offsets[p + 1] += wedge_offsets[p];
+	{
+		std::vector<unsigned int> fill(wedge_offsets.begin(), wedge_offsets.end() - 1);
+		for (unsigned int v = 0; v < vertex_count; v++) wedges[fill[weld[v]]++] = v;
+	}
+
+	// triangles over welded positions, degenerate ones are dropped
+	std::vector<unsigned int> corners, triangles;
+	for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+		unsigned int a = weld[indices[i]], b = weld[indices[i + 1]], c = weld[indices[i + 2]];
+		if (a == b || b == c || c == a) continue;
+		corners.insert(corners.end(), { indices[i], indices[i + 1], indices[i + 2] });
+		triangles.insert(triangles.end(), { a, b, c });
+	}
+	std::size_t triangle_count = triangles.size() / 3;
+	std::vector<bool> removed(triangle_count, false);
+	std::vector<std::vector<unsigned int>> adjacent(count);
+	for (unsigned int t = 0; t < triangle_count; t++)
+		for (int k = 0; k < 3; k++) adjacent[triangles[t * 3 + k]].push_back(t);
+
+	// plane of every face, and perpendicular planes along edges used by a single face
+	std::vector<Quadric> quadrics(count);
+	std::unordered_map<std::uint64_t, int> edges;
+	edges.reserve(triangle_count * 3);
+	for (std::size_t t = 0; t < triangle_count; t++)
+		for (int k = 0; k < 3; k++) {
+			std::uint64_t a = triangles[t * 3 + k], b = triangles[t * 3 + (k + 1) % 3];
+			edges[std::min(a, b) << 32 | std::max(a, b)]++;
+		}
+	for (std::size_t t = 0; t < triangle_count; t++)
+	{
+		unsigned int const* tri = &triangles[t * 3];
+		double n[3];
+		simplify_cross(point(tri[0]), point(tri[1]), point(tri[2]), n);
+		double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length == 0.0) continue;
+		for (double& c : n) c /= length;
+		float const* p0 = point(tri[0]);
+		double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+		for (int k = 0; k < 3; k++) quadrics[tri[k]].AddPlane(n[0], n[1], n[2], d, 1.0);
+
+		for (int k = 0; k < 3; k++)
+		{
+			std::uint64_t a = tri[k], b = tri[(k + 1) % 3];
+			if (edges[std::min(a, b) << 32 | std::max(a, b)] != 1) continue;
+			float const* pa = point(unsigned(a)), * pb = point(unsigned(b));
+			double e[3] = { double(pb[0]) - pa[0], double(pb[1]) - pa[1], double(pb[2]) - pa[2] };
+			double m[3] = { e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0] };
+			double ml = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+			if (ml == 0.0) continue;
+			for (double& c : m) c /= ml;
+			double md = -(m[0] * pa[0] + m[1] * pa[1] + m[2] * pa[2]);
+			quadrics[a].AddPlane(m[0], m[1], m[2], md, simplify_border_weight);
+			quadrics[b].AddPlane(m[0], m[1], m[2], md, simplify_border_weight);
+		}
+	}
+
+	// collapses of one position onto another, cheapest first. Entries are invalidated
+	// lazily by comparing the versions of both ends
+	struct Collapse
+	{
+		double cost;
+		unsigned int from, to, from_version, to_version;
+		bool operator>(Collapse const& c) const { return cost > c.cost; }
+	};
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+	std::vector<unsigned int> version(count, 0), collapsed(count, ~0u);
+	auto push = [&](unsigned int from, unsigned int to) {
+		Quadric q = quadrics[from];
+		q += quadrics[to];
+		queue.push({ q.Error(point(to)), from, to, version[from], version[to] });
+	};
+	for (std::size_t t = 0; t < triangle_count; t++)
+		for (int k = 0; k < 3; k++) {
+			push(triangles[t * 3 + k], triangles[t * 3 + (k + 1) % 3]);
+			push(triangles[t * 3 + (k + 1) % 3], triangles[t * 3 + k]);
+		}
+
+	std::size_t live = triangle_count, target = target_index_count / 3;
+	double max_cost = 0.0;
+	std::vector<unsigned int> neighbors;
+	while (live > target && !queue.empty())
+	{
+		Collapse c = queue.top();
+		queue.pop();
+		if (collapsed[c.from] != ~0u || collapsed[c.to] != ~0u) continue;
+		if (c.from_version != version[c.from] || c.to_version != version[c.to]) continue;
+
+		// moving the position must not fold any of the remaining triangles over
+		bool folds = false;
+		for (unsigned int t : adjacent[c.from])
+		{
+			unsigned int* tri = &triangles[t * 3];
+			if (removed[t] || tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) continue;
+			float const* p[3], * moved[3];
+			for (int k = 0; k < 3; k++) {
+				p[k] = point(tri[k]);
+				moved[k] = tri[k] == c.from ? point(c.to) : p[k];
+			}
+			double before[3], after[3];
+			simplify_cross(p[0], p[1], p[2], before);
+			simplify_cross(moved[0], moved[1], moved[2], after);
+			double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+			double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+				* (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+			if (lengths == 0.0 || dot < simplify_max_turn * lengths) { folds = true; break; }
+		}
+		if (folds) continue;
+
+		max_cost = std::max(max_cost, c.cost);
+		for (unsigned int t : adjacent[c.from])
+		{
+			if (removed[t]) continue;
+			unsigned int* tri = &triangles[t * 3];
+			if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+				removed[t] = true;
+				live--;
+				continue;
+			}
+			for (int k = 0; k < 3; k++) if (tri[k] == c.from) tri[k] = c.to;
+			adjacent[c.to].push_back(t);
+		}
+		adjacent[c.from].clear();
+		collapsed[c.from] = c.to;
+		quadrics[c.to] += quadrics[c.from];
+		version[c.to]++;
+
+		// the collapsed position changed every edge around it
+		auto& around = adjacent[c.to];
+		around.erase(std::remove_if(around.begin(), around.end(), [&](unsigned int t) { return removed[t]; }), around.end());
+		neighbors.clear();
+		for (unsigned int t : around)
+			for (int k = 0; k < 3; k++)
+				if (triangles[t * 3 + k] != c.to) neighbors.push_back(triangles[t * 3 + k]);
+		std::sort(neighbors.begin(), neighbors.end());
+		neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+		for (unsigned int n : neighbors) {
+			push(c.to, n);
+			push(n, c.to);
+		}
+	}
+
+	// corners that moved take the vertex at their new position with the closest attributes
+	auto closest = [&](unsigned int vertex, unsigned int p) {
+		float const* a = position(vertex);
+		unsigned int best = representative[p];
+		float best_distance = std::numeric_limits<float>::max();
+		for (unsigned int i = wedge_offsets[p]; i < wedge_offsets[p + 1]; i++) {
+			float const* b = position(wedges[i]);
+			float distance = 0.0f;
+			for (int k = 3; k < simplify_stride; k++) distance += (a[k] - b[k]) * (a[k] - b[k]);
+			if (distance < best_distance) { best_distance = distance; best = wedges[i]; }
+		}
+		return best;
+	};
+
+	std::vector<unsigned int> result;
+	result.reserve(live * 3);
+	for (std::size_t t = 0; t < triangle_count; t++) {
+		if (removed[t]) continue;
+		for (int k = 0; k < 3; k++) {
+			unsigned int vertex = corners[t * 3 + k], p = triangles[t * 3 + k];
+			result.push_back(weld[vertex] == p ? vertex : closest(vertex, p));
+		}
+	}
+	if (error) *error = float(std::sqrt(max_cost));
+	return result;
+}
+
+void GenerateLods(MeshData& data, int max_levels, float reduction)
+{
+	data.lods.assign(1, { 0, unsigned(data.indices.size()), 0.0f });
+	for (int level = 1; level < max_levels; level++)
+	{
+		MeshLod previous = data.lods.back();
+		std::size_t target = std::size_t(previous.count * reduction) / 3 * 3;
+		if (target < lod_min_triangles * 3) break;
+
+		float error;
+		std::vector<unsigned int> simplified = SimplifyMesh(data,
+			std::span<unsigned int const>(data.indices.data() + previous.first, previous.count), target, &error);
+		if (simplified.size() < lod_min_triangles * 3 || simplified.size() > previous.count * lod_min_reduction) break;
+
+		data.lods.push_back({ unsigned(data.indices.size()), unsigned(simplified.size()), previous.error + error });
+		data.indices.insert(data.indices.end(), simplified.begin(), simplified.end());
+	}
+}
+
+}
@@ -0,0 +1,120 @@
+#include "./private_control.hpp"
+
+namespace Maya {
+
+void DamageTracker::Invalidate(Ivec4 const& rect)
+{
+	if (rect[2] <= 0 || rect[3] <= 0) return;
+	Ivec4 box(rect[0], rect[1], rect[0] + rect[2], rect[1] + rect[3]);
+	if (pending[2] <= pending[0] || pending[3] <= pending[1]) pending = box;
+	else pending = Ivec4(std::min(pending[0], box[0]), std::min(pending[1], box[1]),
+		std::max(pending[2], box[2]), std::max(pending[3], box[3]));
+}
+
+void DamageTracker::InvalidateAll()
+{
+	full = true;
+}
+
+void DamageTracker::BeginFrame(unsigned int framebuffer, Ivec2 size)
+{
+	if (!(this->size == size)) {
+		this->size = size;
+		tiles = Ivec2((size[0] + tile_size - 1) / tile_size, (size[1] + tile_size - 1) / tile_size);
+		previous.assign(std::size_t(tiles[0]) * tiles[1], 0);
+		full = true;
+	}
+	current.assign(std::size_t(tiles[0]) * tiles[1], hash_seed);
+	deferred.clear();
+	this->framebuffer = framebuffer;
+	active = true;
+	immediate = false;
+}
+
+Ivec4 DamageTracker::EndFrame()
+{
+	// a tile changes both where a draw left and where it arrived
+	for (int y = 0; y < tiles[1]; y++)
+	{
+		for (int x = 0; x < tiles[0]; x++)
+		{
+			std::size_t i = std::size_t(y) * tiles[0] + x;
+			if (current[i] == previous[i]) continue;
+			previous[i] = current[i];
+			Invalidate(Ivec4(x * tile_size, y * tile_size, tile_size, tile_size));
+		}
+	}
+
+	Ivec4 region(0);
+	if (full || immediate) region = Ivec4(0, 0, size[0], size[1]);
+	else if (pending[2] > pending[0] && pending[3] > pending[1]) {
+		int x0 = std::max(pending[0], 0), y0 = std::max(pending[1], 0);
+		int x1 = std::min(pending[2], size[0]), y1 = std::min(pending[3], size[1]);
+		region = Ivec4(x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0));
+	}
+
+	// an immediate frame has already been drawn as a whole
+	if (!immediate && region[2] > 0 && region[3] > 0) Redraw(region);
+	deferred.clear();
+	active = false;
+	full = false;
+	pending = Ivec4(0);
+	return region;
+}
+
+bool DamageTracker::Tracking() const
+{
+	return active && PrivateControl::Instance().gl.GetFramebuffer() == framebuffer;
+}
+
+bool DamageTracker::Deferring() const
+{
+	return !immediate && Tracking();
+}
+
+void DamageTracker::Defer(std::function<void()> draw)
+{
+	deferred.push_back(std::move(draw));
+}
+
+void DamageTracker::DrawImmediately()
+{
+	if (!Deferring()) return;
+	immediate = true;
+	Redraw(Ivec4(0, 0, size[0], size[1]));
+	deferred.clear();
+}
+
+void DamageTracker::Redraw(Ivec4 const& region)
+{
+	// clearing is affected by the scissor test and the depth mask
+	auto& gl = PrivateControl::Instance().gl;
+	gl.SetScissorTest(false);
+	gl.SetScissorLimit(framebuffer, region);
+	gl.SetDepthWrite(true);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+	for (auto& draw : deferred)
+		draw();
+
+	// draws that follow DrawImmediately cover the whole framebuffer
+	gl.SetScissorLimit(0, Ivec4(-1));
+}
+
+void DamageTracker::Report(Fvec4 const& bounds, std::uint64_t hash)
+{
+	if (bounds[2] < 0.0f || bounds[3] < 0.0f) return;
+	int x0 = std::max(int(std::floor(bounds[0])) / tile_size, 0), y0 = std::max(int(std::floor(bounds[1])) / tile_size, 0);
+	int x1 = std::min(int(std::ceil(bounds[2])) / tile_size, tiles[0] - 1), y1 = std::min(int(std::ceil(bounds[3])) / tile_size, tiles[1] - 1);
+
+	// mixing is order dependent, so reordered draws damage their tiles too
+	for (int y = y0; y <= y1; y++)
+		for (int x = x0; x <= x1; x++) {
+			std::uint64_t& tile = current[std::size_t(y) * tiles[0] + x];
+			tile = (tile ^ hash) * 0x100000001B3ull;
+			tile ^= tile >> 29;
+		}
+}
+
+}
@@ -4,44 +4,96 @@
 
 namespace Maya {
 
-Font::Font(std::string const& path, int pixel_size)
+// Rasterized glyph waiting to be packed into the atlas
+struct FontBitmap
+{
+    std::vector<unsigned char> pixels;
+    Ivec2 size, bearing, position;
+    unsigned advance;
+};
+
+Font::Font(std::string const& path, int pixel_size, bool sdf)
+    : pixel_size(pixel_size), sdf(sdf)
 {
     FT_Library ft;
     FT_Init_FreeType(&ft);
     FT_Face face;
     FT_New_Face(ft, path.c_str(), 0, &face);
     FT_Set_Pixel_Sizes(face, 0, pixel_size);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
+    std::vector<FontBitmap> bitmaps(96);
     for (unsigned char c = 32; c < 128; c++)
     {
-        FT_Load_Char(face, c, FT_LOAD_RENDER);
+        // distance fields are 8 bit images where 128 is the outline and larger values are inside
+        if (sdf) {
+            FT_Load_Char(face, c, FT_LOAD_DEFAULT);
+            FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF);
+        }
+        else FT_Load_Char(face, c, FT_LOAD_RENDER);
         auto& map = face->glyph->bitmap;
+        auto& bitmap = bitmaps[c - 32];
+        bitmap.pixels.assign(map.buffer, map.buffer + map.width * map.rows);
+        bitmap.size = Ivec2(map.width, map.rows);
+        bitmap.bearing = Ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+        bitmap.advance = unsigned(face->glyph->advance.x);
+    }
 
-        std::vector<unsigned char> image;
-        image.reserve(map.width * map.rows * 4);
+    FT_Done_Face(face);
+    FT_Done_FreeType(ft);
 
-        for (unsigned j = 0; j < map.rows; j++)
-            for (unsigned i = 0; i < map.width; i++)
-                for (unsigned k = 0; k < 4; k++)
-                    image.emplace_back(map.buffer[(map.rows - j - 1) * map.width + i]);
+    // shelf packing, glyphs are placed in rows with 1 pixel padding
+    // distance fields are surrounded by the default spread of 8 pixels
+    constexpr int padding = 1;
+    int cell = pixel_size + padding + (sdf ? 16 : 0);
+    int width = 256;
+    while (width * width < 96 * cell * cell)
+        width *= 2;
 
-        Texture* tex = new Texture(image.data(), Ivec2(map.width, map.rows), 4);
+    int x = padding, y = padding, row_height = 0;
+    for (auto& bitmap : bitmaps)
+    {
+        if (x + bitmap.size[0] + padding > width) {
+            x = padding;
+            y += row_height + padding;
+            row_height = 0;
+        }
+        bitmap.position = Ivec2(x, y);
+        x += bitmap.size[0] + padding;
+        row_height = std::max(row_height, bitmap.size[1]);
+    }
+
+    int height = 1;
+    while (height < y + row_height + padding)
+        height *= 2;
+
+    // rows are flipped, as textures begin from the bottom left corner
+    std::vector<unsigned char> image(width * height * 4, 0);
+    for (auto& bitmap : bitmaps)
+        for (int j = 0; j < bitmap.size[1]; j++)
+            for (int i = 0; i < bitmap.size[0]; i++)
+            {
+                unsigned char value = bitmap.pixels[(bitmap.size[1] - j - 1) * bitmap.size[0] + i];
+                unsigned char* pixel = &image[((bitmap.position[1] + j) * width + bitmap.position[0] + i) * 4];
+                pixel[0] = pixel[1] = pixel[2] = pixel[3] = value;
+            }
+
+    atlas = new Texture(image.data(), Ivec2(width, height), 4);
+
+    for (unsigned char c = 32; c < 128; c++)
+    {
+        auto& bitmap = bitmaps[c - 32];
         glyphs[c] = {
-            tex, Ivec2(map.width, map.rows),
-            Ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            unsigned(face->glyph->advance.x)
+            atlas,
+            Fvec2(float(bitmap.position[0]) / width, float(bitmap.position[1]) / height),
+            Fvec2(float(bitmap.position[0] + bitmap.size[0]) / width, float(bitmap.position[1] + bitmap.size[1]) / height),
+            bitmap.size, bitmap.bearing, bitmap.advance
         };
     }
-
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
 }
 
 Font::~Font()
 {
-    for (auto& pair : glyphs)
-        delete pair.second.texture;
+    delete atlas;
 }
 
 Glyph Font::operator[](unsigned char c) const
@@ -49,4 +101,19 @@ Glyph Font::operator[](unsigned char c) const
     return glyphs.at(c);
 }
 
-}
\ No newline at end of file
+Texture* Font::GetAtlas() const
+{
+    return atlas;
+}
+
+int Font::GetPixelSize() const
+{
+    return pixel_size;
+}
+
+bool Font::IsSDF() const
+{
+    return sdf;
+}
+
+}
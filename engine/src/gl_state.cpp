@@ -0,0 +1,168 @@
+#include "./private_control.hpp"
+
+namespace Maya {
+
+bool GLState::Change(bool changed)
+{
+	auto& stats = Stats();
+	(changed ? stats.issued : stats.skipped)++;
+	return changed;
+}
+
+StateChangeStatistics& GLState::Stats()
+{
+	auto now = PrivateControl::Instance().frame;
+	if (now != frame) {
+		last = now == frame + 1 ? current : StateChangeStatistics{};
+		current = {};
+		frame = now;
+	}
+	return current;
+}
+
+void GLState::UseProgram(unsigned int program)
+{
+	if (!Change(this->program != program)) return;
+	this->program = program;
+	glUseProgram(program);
+}
+
+void GLState::BindVertexArray(unsigned int vao)
+{
+	if (!Change(this->vao != vao)) return;
+	this->vao = vao;
+	glBindVertexArray(vao);
+}
+
+void GLState::BindTexture(int unit, unsigned int texture)
+{
+	if (!Change(textures[unit] != texture)) return;
+	if (active_unit != unit) {
+		active_unit = unit;
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+	textures[unit] = texture;
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLState::BindFramebuffer(unsigned int framebuffer)
+{
+	if (!Change(this->framebuffer != framebuffer)) return;
+	this->framebuffer = framebuffer;
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	if (scissor_limit[2] >= 0) ApplyScissor();
+}
+
+void GLState::BlitFramebuffer(unsigned int source, unsigned int destination, Ivec2 size)
+{
+	// blits are cut by the scissor test, it is enabled again by the next SetScissorTest
+	if (sent_scissor_test) {
+		sent_scissor_test = false;
+		glDisable(GL_SCISSOR_TEST);
+	}
+	Change(true);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destination);
+	glBlitFramebuffer(0, 0, size[0], size[1], 0, 0, size[0], size[1], GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+	// the read and draw bindings now differ, so the next bind is always sent
+	framebuffer = ~0u;
+}
+
+void GLState::SetBlend(bool enabled)
+{
+	if (!Change(blend != enabled)) return;
+	blend = enabled;
+	enabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+}
+
+void GLState::SetBlendFunction(unsigned int source, unsigned int destination)
+{
+	if (!Change(blend_source != source || blend_destination != destination)) return;
+	blend_source = source;
+	blend_destination = destination;
+	glBlendFunc(source, destination);
+}
+
+void GLState::SetDepthTest(bool enabled)
+{
+	if (!Change(depth_test != enabled)) return;
+	depth_test = enabled;
+	enabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+}
+
+void GLState::SetDepthWrite(bool enabled)
+{
+	if (!Change(depth_write != enabled)) return;
+	depth_write = enabled;
+	glDepthMask(enabled);
+}
+
+void GLState::SetScissorTest(bool enabled)
+{
+	scissor_test = enabled;
+	ApplyScissor();
+}
+
+void GLState::SetScissor(Ivec4 const& rect)
+{
+	scissor = rect;
+	ApplyScissor();
+}
+
+void GLState::SetScissorLimit(unsigned int framebuffer, Ivec4 const& rect)
+{
+	limit_framebuffer = framebuffer;
+	scissor_limit = rect;
+	ApplyScissor();
+}
+
+void GLState::ApplyScissor()
+{
+	bool limited = scissor_limit[2] >= 0 && framebuffer == limit_framebuffer;
+	bool test = scissor_test || limited;
+	Ivec4 rect = scissor;
+	if (limited && !scissor_test) rect = scissor_limit;
+	else if (limited) {
+		int x0 = std::max(scissor[0], scissor_limit[0]), y0 = std::max(scissor[1], scissor_limit[1]);
+		int x1 = std::min(scissor[0] + scissor[2], scissor_limit[0] + scissor_limit[2]);
+		int y1 = std::min(scissor[1] + scissor[3], scissor_limit[1] + scissor_limit[3]);
+		rect = Ivec4(x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0));
+	}
+
+	if (Change(sent_scissor_test != test)) {
+		sent_scissor_test = test;
+		test ? glEnable(GL_SCISSOR_TEST) : glDisable(GL_SCISSOR_TEST);
+	}
+	if (test && Change(!(sent_scissor == rect))) {
+		sent_scissor = rect;
+		glScissor(rect[0], rect[1], rect[2], rect[3]);
+	}
+}
+
+void GLState::SetViewport(Ivec4 const& rect)
+{
+	if (!Change(!(viewport == rect))) return;
+	viewport = rect;
+	glViewport(rect[0], rect[1], rect[2], rect[3]);
+}
+
+void GLState::ForgetTexture(unsigned int texture)
+{
+	for (auto& bound : textures)
+		if (bound == texture) bound = 0;
+}
+
+void GLState::ForgetFramebuffer(unsigned int framebuffer)
+{
+	if (this->framebuffer == framebuffer) this->framebuffer = 0;
+}
+
+StateChangeStatistics GetStateChangeStatistics()
+{
+	auto& gl = PrivateControl::Instance().gl;
+	gl.Stats();
+	return gl.last;
+}
+
+}
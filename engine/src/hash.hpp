@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Maya/core.hpp>
+
+namespace Maya {
+
+constexpr std::uint64_t hash_seed = 0xCBF29CE484222325ull;
+
+// FNV-1a over 32 bit words with the tail folded byte by byte, chained through the seed.
+// Used for redraw tracking, vertex deduplication and welding, where speed matters more than quality
+inline std::uint64_t HashBytes(void const* data, std::size_t bytes, std::uint64_t seed = hash_seed)
+{
+	auto const* p = static_cast<std::uint8_t const*>(data);
+	std::uint64_t h = seed;
+	std::size_t i = 0;
+	for (; i + 4 <= bytes; i += 4) {
+		std::uint32_t word;
+		std::memcpy(&word, p + i, 4);
+		h = (h ^ word) * 0x100000001B3ull;
+	}
+	for (; i < bytes; i++)
+		h = (h ^ p[i]) * 0x100000001B3ull;
+	return h;
+}
+
+}
@@ -13,6 +13,12 @@ static void CreateWindowEventCallback(GLFWwindow* window)
 			data.callback(KeyEvent(KeyCode(key), act == GLFW_PRESS));
 	});
 
+	glfwSetCharCallback(window,
+	[](GLFWwindow* window, unsigned int codepoint) {
+		auto& data = *(WindowData*)glfwGetWindowUserPointer(window);
+		data.callback(CharEvent(codepoint));
+	});
+
 	glfwSetMouseButtonCallback(window,
 	[](GLFWwindow* window, int button, int act, int modes) {
 		auto& data = *(WindowData*)glfwGetWindowUserPointer(window);
@@ -50,6 +56,7 @@ static void CreateWindowEventCallback(GLFWwindow* window)
 	[](GLFWwindow* window, int width, int height) {
 		auto& data = *(WindowData*)glfwGetWindowUserPointer(window);
 		data.size = Ivec2(width, height);
+		PrivateControl::Instance().gl.SetViewport(Ivec4(0, 0, width, height));
 		data.callback(WindowResizedEvent(data.size));
 	});
 
@@ -85,10 +92,11 @@ void CreateWindowInstance(WindowConfiguration& cfg)
 	if (cfg.fps == Vsync) glfwSwapInterval(1);
 	CreateWindowEventCallback(ctrl.window);
 	gladLoadGL();
-	glViewport(0, 0, ctrl.windata.size[0], ctrl.windata.size[1]);
-	glEnable(GL_BLEND);
+	ctrl.gl.SetViewport(Ivec4(0, 0, ctrl.windata.size[0], ctrl.windata.size[1]));
+	ctrl.gl.SetBlend(true);
+	ctrl.gl.SetBlendFunction(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glEnable(GL_MULTISAMPLE);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 }
 
 int PrivateControl::MainFunction()
@@ -118,12 +126,25 @@ int PrivateControl::MainFunction()
 		float elapsed = glfwGetTime() - begin;
 		if (windata.fps > 0 && elapsed < 1.0f / windata.fps) continue;
 		begin = glfwGetTime();
-
-		glClear(GL_COLOR_BUFFER_BIT);
-		glClearColor(0, 0, 0, 0);
-		
-		if (current_scene)
-			current_scene->OnTick(elapsed);
+		frame++;
+
+		// clip rectangles are left enabled by the last flush of the previous frame, the clear must cover everything
+		gl.SetScissorTest(false);
+
+		if (redraw_mode == RedrawMode::Damaged)
+		{
+			if (!DrawDamaged(elapsed)) {
+				// nothing to present, sleep until an event arrives or the next frame is due
+				glfwWaitEventsTimeout(windata.fps > 0 ? 1.0 / windata.fps : 1.0 / 60.0);
+				continue;
+			}
+		}
+		else
+		{
+			glClear(GL_COLOR_BUFFER_BIT);
+			glClearColor(0, 0, 0, 0);
+			TickScene(elapsed);
+		}
 
 		glfwSwapBuffers(window);
 		glfwPollEvents();
@@ -132,6 +153,40 @@ int PrivateControl::MainFunction()
 	return 0;
 }
 
+void PrivateControl::TickScene(float elapsed)
+{
+	if (current_scene)
+		current_scene->OnTick(elapsed);
+	for (auto& fn : frame_end_callbacks)
+		fn();
+}
+
+bool PrivateControl::DrawDamaged(float elapsed)
+{
+	if (windata.size[0] <= 0 || windata.size[1] <= 0) {
+		TickScene(elapsed);
+		return false;
+	}
+	if (!canvas) {
+		// blitting into a multisampled window needs the same number of samples
+		int samples;
+		glGetIntegerv(GL_SAMPLES, &samples);
+		canvas = std::make_unique<RenderTarget>(Ivec2(0), std::max(samples, 1), true);
+	}
+
+	// the canvas is not cleared, everything outside the damaged region is kept from the last frame
+	canvas->Begin(false);
+	damage.BeginFrame(canvas->framebuffer, canvas->GetSize());
+	TickScene(elapsed);
+	Ivec4 region = damage.EndFrame();
+	canvas->End();
+
+	if (region[2] <= 0 || region[3] <= 0) return false;
+	gl.BlitFramebuffer(canvas->framebuffer, 0, canvas->GetSize());
+	gl.BindFramebuffer(0);
+	return true;
+}
+
 PrivateControl::~PrivateControl()
 {
 	Pa_Terminate();
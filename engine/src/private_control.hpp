@@ -4,9 +4,118 @@
 #include <glad/glad.h>
 #include <glfw/glfw3.h>
 #include <portaudio.h>
+#include "./hash.hpp"
 
 namespace Maya {
 
+// Shadow copy of the OpenGL state, every engine bind and state change goes through it
+// so that calls setting a value that is already current are not sent to the driver
+class GLState
+{
+public:
+	static constexpr int texture_units = 16;
+
+	void UseProgram(unsigned int program);
+	void BindVertexArray(unsigned int vao);
+	void BindTexture(int unit, unsigned int texture);
+	void BindFramebuffer(unsigned int framebuffer);
+
+	// Copy the color buffer of a framebuffer into another one of the same size, e.g. to resolve multisampling
+	void BlitFramebuffer(unsigned int source, unsigned int destination, Ivec2 size);
+
+	void SetBlend(bool enabled);
+	void SetBlendFunction(unsigned int source, unsigned int destination);
+	void SetDepthTest(bool enabled);
+	void SetDepthWrite(bool enabled);
+	void SetScissorTest(bool enabled);
+	void SetScissor(Ivec4 const& rect);
+	void SetViewport(Ivec4 const& rect);
+
+	// Confine every draw into a framebuffer to a rectangle, on top of the scissor test requested by SetScissor
+	// @param rect: (x, y, width, height) in pixels, a negative width removes the limit
+	void SetScissorLimit(unsigned int framebuffer, Ivec4 const& rect);
+
+	unsigned int GetFramebuffer() const { return framebuffer; }
+	Ivec4 GetViewport() const { return viewport; }
+
+	// Forget deleted objects, since their names could be reused by OpenGL
+	void ForgetTexture(unsigned int texture);
+	void ForgetFramebuffer(unsigned int framebuffer);
+
+	// Statistics of the current frame, rolls over when a new frame begins
+	StateChangeStatistics& Stats();
+	StateChangeStatistics last = {};
+
+private:
+	unsigned int program = 0, vao = 0, framebuffer = 0;
+	int active_unit = 0;
+	unsigned int textures[texture_units] = {};
+	bool blend = false, depth_test = false, depth_write = true;
+	unsigned int blend_source = GL_ONE, blend_destination = GL_ZERO;
+	Ivec4 viewport = Ivec4(-1);
+
+	// requested scissor state, and the one sent after applying the limit
+	bool scissor_test = false, sent_scissor_test = false;
+	Ivec4 scissor = Ivec4(-1), sent_scissor = Ivec4(-1), scissor_limit = Ivec4(-1);
+	unsigned int limit_framebuffer = 0;
+	std::uint64_t frame = 0;
+	StateChangeStatistics current = {};
+
+	// Count the change and return true if it has to be sent
+	bool Change(bool changed);
+	void ApplyScissor();
+};
+
+// Finds the parts of the window that changed since the last frame, used by RedrawMode::Damaged.
+// Draws of Graphics2D are hashed into a grid of tiles, a tile whose hash differs from the last
+// frame is damaged. Draws into the tracked framebuffer are deferred while the scene ticks, so the
+// damage is known before anything is rasterized and both the old and the new place of a moving
+// draw are redrawn in the same frame.
+class DamageTracker
+{
+public:
+	static constexpr int tile_size = 64;
+
+	// Mark a rectangle (x, y, width, height) in window pixels to be redrawn
+	void Invalidate(Ivec4 const& rect);
+	void InvalidateAll();
+
+	// Start tracking and deferring the draws into a framebuffer of the given size
+	void BeginFrame(unsigned int framebuffer, Ivec2 size);
+
+	// Compare the tiles against the last frame and redraw the damaged rectangle with the deferred draws
+	// @returns the redrawn rectangle, zero sized if nothing changed
+	Ivec4 EndFrame();
+
+	// Check if draws are being tracked, i.e. if the tracked framebuffer is bound
+	bool Tracking() const;
+
+	// Check if draws into the bound framebuffer have to be passed to Defer instead of OpenGL
+	bool Deferring() const;
+
+	// Keep a draw until the damage of the frame is known, it must own copies of whatever it reads
+	void Defer(std::function<void()> draw);
+
+	// Called before a draw that cannot be deferred, e.g. by Graphics3D. The deferred draws are replayed
+	// over a cleared framebuffer right away, then the rest of the frame is drawn as it comes.
+	void DrawImmediately();
+
+	// Fold the hash of a draw into every tile it covers
+	// @param bounds: (min x, min y, max x, max y) in pixels
+	void Report(Fvec4 const& bounds, std::uint64_t hash);
+
+private:
+	bool active = false, full = true, immediate = false;
+	unsigned int framebuffer = 0;
+	Ivec2 size = Ivec2(0), tiles = Ivec2(0);
+	std::vector<std::uint64_t> current, previous;
+	std::vector<std::function<void()>> deferred;
+	Ivec4 pending = Ivec4(0); // (min x, min y, max x, max y) of the damage to be redrawn
+
+	// Clear a rectangle (x, y, width, height) of the tracked framebuffer and replay the deferred draws inside it
+	void Redraw(Ivec4 const& region);
+};
+
 class PrivateControl
 {
 private:
@@ -34,9 +143,23 @@ public:
 
 	std::unordered_map<std::string, std::unique_ptr<Scene>> scenes;
 	Scene* current_scene = nullptr;
+	std::uint64_t frame = 0; // index of the frame being drawn
+	std::vector<std::function<void()>> frame_end_callbacks; // called after the scene is ticked
+	std::vector<std::function<void()>> flush_callbacks; // submit batched draws, called before the framebuffer changes
+	GLState gl;
+
+	RedrawMode redraw_mode = RedrawMode::Full;
+	DamageTracker damage;
+	std::unique_ptr<RenderTarget> canvas; // keeps the last frame in RedrawMode::Damaged
 
 public:
 	int MainFunction();
+
+private:
+	void TickScene(float elapsed);
+
+	// Redraw the damaged part of the canvas and copy it to the window, returns false if nothing changed
+	bool DrawDamaged(float elapsed);
 };
 
 
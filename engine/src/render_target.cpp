@@ -0,0 +1,126 @@
+#include "./private_control.hpp"
+
+namespace Maya {
+
+RenderTarget::RenderTarget(Ivec2 size, int samples, bool depth_stencil)
+	: color_buffer(0), depth_buffer(0), size(size), samples(std::max(samples, 1)), depth_stencil(depth_stencil),
+	  follow_window(size[0] <= 0 || size[1] <= 0), previous_framebuffer(0), previous_viewport(0)
+{
+	if (follow_window) this->size = GetWindowSize();
+
+	int max_samples;
+	glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+	this->samples = std::min(this->samples, max_samples);
+
+	glGenFramebuffers(1, &framebuffer);
+	resolve_framebuffer = 0;
+	if (this->samples > 1) {
+		glGenFramebuffers(1, &resolve_framebuffer);
+		glGenRenderbuffers(1, &color_buffer);
+	}
+	if (depth_stencil) glGenRenderbuffers(1, &depth_buffer);
+
+	texture = new Texture(nullptr, this->size, 4);
+	texture->Bind(0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	Allocate();
+}
+
+RenderTarget::~RenderTarget()
+{
+	auto& gl = PrivateControl::Instance().gl;
+	glDeleteFramebuffers(1, &framebuffer);
+	gl.ForgetFramebuffer(framebuffer);
+	if (resolve_framebuffer) {
+		glDeleteFramebuffers(1, &resolve_framebuffer);
+		gl.ForgetFramebuffer(resolve_framebuffer);
+	}
+	if (color_buffer) glDeleteRenderbuffers(1, &color_buffer);
+	if (depth_buffer) glDeleteRenderbuffers(1, &depth_buffer);
+	delete texture;
+}
+
+void RenderTarget::Allocate()
+{
+	auto& gl = PrivateControl::Instance().gl;
+	unsigned int previous = gl.GetFramebuffer();
+
+	// with multisampling, draws go into renderbuffers and the texture is attached to the resolve framebuffer
+	gl.BindFramebuffer(resolve_framebuffer ? resolve_framebuffer : framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->textureid, 0);
+
+	gl.BindFramebuffer(framebuffer);
+	if (color_buffer) {
+		glBindRenderbuffer(GL_RENDERBUFFER, color_buffer);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, size[0], size[1]);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer);
+	}
+	if (depth_buffer) {
+		glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, color_buffer ? samples : 0, GL_DEPTH24_STENCIL8, size[0], size[1]);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_buffer);
+	}
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+#if MAYA_DEBUG
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "RenderTarget of size " << size[0] << "x" << size[1] << " is incomplete\n";
+#endif
+	gl.BindFramebuffer(previous);
+}
+
+void RenderTarget::Begin(bool clear)
+{
+	auto& ctrl = PrivateControl::Instance();
+	if (follow_window && !(GetWindowSize() == size))
+		Resize(GetWindowSize());
+
+	// draws batched so far belong to the framebuffer bound before
+	for (auto& fn : ctrl.flush_callbacks)
+		fn();
+
+	previous_framebuffer = ctrl.gl.GetFramebuffer();
+	previous_viewport = ctrl.gl.GetViewport();
+	ctrl.gl.BindFramebuffer(framebuffer);
+	ctrl.gl.SetViewport(Ivec4(0, 0, size[0], size[1]));
+	if (!clear) return;
+
+	// clearing is affected by the scissor test and the depth mask
+	ctrl.gl.SetScissorTest(false);
+	ctrl.gl.SetDepthWrite(true);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT | (depth_buffer ? GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT : 0));
+}
+
+void RenderTarget::End()
+{
+	auto& ctrl = PrivateControl::Instance();
+	for (auto& fn : ctrl.flush_callbacks)
+		fn();
+
+	if (resolve_framebuffer)
+		ctrl.gl.BlitFramebuffer(framebuffer, resolve_framebuffer, size);
+	ctrl.gl.BindFramebuffer(previous_framebuffer);
+	ctrl.gl.SetViewport(previous_viewport);
+}
+
+void RenderTarget::Resize(Ivec2 size)
+{
+	if (size[0] <= 0 || size[1] <= 0 || this->size == size) return;
+	this->size = size;
+	texture->Resize(size);
+	Allocate();
+}
+
+Texture& RenderTarget::GetTexture()
+{
+	return *texture;
+}
+
+Ivec2 RenderTarget::GetSize() const
+{
+	return size;
+}
+
+}
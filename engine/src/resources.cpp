@@ -18,4 +18,18 @@ ResourcesManager::ResourcesManager()
 #endif
 }
 
+SubTexture const* ResourcesManager::CreateSubTexture(std::string const& name, std::string const& path)
+{
+	SubTexture const* sub = atlas.Add(path);
+	if (sub) sub_textures[name] = sub;
+	return sub;
+}
+
+SubTexture const* ResourcesManager::CreateSubTexture(std::string const& name, std::uint8_t const* data, Ivec2 size, int channels)
+{
+	SubTexture const* sub = atlas.Add(data, size, channels);
+	if (sub) sub_textures[name] = sub;
+	return sub;
+}
+
 }
\ No newline at end of file
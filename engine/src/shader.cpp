@@ -47,8 +47,6 @@ static struct Shader_OpenGLResourceReleaser {
 	}
 } releaser;
 
-static Shader* current_shader = nullptr;
-
 Shader::Shader(std::string const& vertex, std::string const& fragment, bool is_file_name)
 {
 	shaderid = glCreateProgram();
@@ -65,9 +63,13 @@ Shader::Shader(std::string const& vertex, std::string const& fragment, bool is_f
 
 void Shader::Bind()
 {
-	if (this == current_shader) return;
-	current_shader = this;
-	glUseProgram(shaderid);
+	PrivateControl::Instance().gl.UseProgram(shaderid);
+}
+
+void Shader::BindUniformBlock(std::string const& name, int binding)
+{
+	unsigned int index = glGetUniformBlockIndex(shaderid, name.c_str());
+	if (index != GL_INVALID_INDEX) glUniformBlockBinding(shaderid, index, binding);
 }
 
 int Shader::GetUniformLocation(std::string const& name)
@@ -19,21 +19,19 @@ Texture::Texture(std::uint8_t const* data, Ivec2 size, int channels)
 {
 	this->size = size;
 	glGenTextures(1, &textureid);
-	glBindTexture(GL_TEXTURE_2D, textureid);
+	PrivateControl::Instance().gl.BindTexture(0, textureid);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size[0], size[1], 0, texture_format(channels), GL_UNSIGNED_BYTE, data);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 Texture::Texture(std::string const& path, int channels)
 {
 	glGenTextures(1, &textureid);
-	glBindTexture(GL_TEXTURE_2D, textureid);
+	PrivateControl::Instance().gl.BindTexture(0, textureid);
 
 	stbi_set_flip_vertically_on_load(true);
 	int ch;
@@ -46,19 +44,36 @@ Texture::Texture(std::string const& path, int channels)
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size[0], size[1], 0,
 		texture_format(channels == 0 || ch < channels ? ch : channels), GL_UNSIGNED_BYTE, data);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
 	if (data) stbi_image_free(data);
 }
 
 Texture::~Texture()
 {
 	glDeleteTextures(1, &textureid);
+	PrivateControl::Instance().gl.ForgetTexture(textureid);
 }
 
 void Texture::Bind(int slot)
 {
-	glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTexture(GL_TEXTURE_2D, textureid);
+	PrivateControl::Instance().gl.BindTexture(slot, textureid);
+}
+
+void Texture::Update(std::uint8_t const* data, Ivec2 offset, Ivec2 size, int channels)
+{
+	PrivateControl::Instance().gl.BindTexture(0, textureid);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, offset[0], offset[1], size[0], size[1], texture_format(channels), GL_UNSIGNED_BYTE, data);
+}
+
+void Texture::Resize(Ivec2 size)
+{
+	this->size = size;
+	PrivateControl::Instance().gl.BindTexture(0, textureid);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size[0], size[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+}
+
+Ivec2 Texture::GetSize() const
+{
+	return size;
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include "./private_control.hpp"
+#include <stb/stb_image.h>
+
+namespace Maya {
+
+static constexpr int atlas_initial_page_size = 256;
+
+struct TextureAtlas::Page
+{
+	Texture* texture;
+	Ivec2 size;
+	std::vector<std::uint8_t> pixels; // rgba copy of the texture, needed to rebuild it when growing
+	std::vector<Ivec4> rects; // (x, y, width, height) of every entry, padding excluded
+	std::vector<std::unique_ptr<SubTexture>> entries;
+	std::int64_t used_area = 0;
+
+	// Skyline of the packed region, each node is a horizontal segment
+	// at height y spanning [x, x + width)
+	struct Node { int x, y, width; };
+	std::vector<Node> skyline;
+
+	Page(Ivec2 size)
+		: size(size), pixels(std::size_t(size[0]) * size[1] * 4, 0)
+	{
+		texture = new Texture(pixels.data(), size, 4);
+		PrivateControl::Instance().gl.BindTexture(0, texture->textureid);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		skyline.push_back({ 0, 0, size[0] });
+	}
+
+	~Page()
+	{
+		delete texture;
+	}
+
+	// Lowest y an area of width w could rest at when its left edge is on node i, -1 if it cannot
+	int Fit(std::size_t i, int w, int h) const
+	{
+		int x = skyline[i].x;
+		if (x + w > size[0]) return -1;
+		int y = 0;
+		for (int remain = w; remain > 0; i++) {
+			y = std::max(y, skyline[i].y);
+			if (y + h > size[1]) return -1;
+			remain -= skyline[i].width;
+		}
+		return y;
+	}
+
+	// Find the bottom left most position for an area, returns false if the page is full
+	bool Insert(int w, int h, Ivec2& position)
+	{
+		int best = -1, best_y = size[1], best_width = 0;
+		for (std::size_t i = 0; i < skyline.size(); i++) {
+			int y = Fit(i, w, h);
+			if (y < 0) continue;
+			if (y < best_y || (y == best_y && skyline[i].width < best_width)) {
+				best = int(i);
+				best_y = y;
+				best_width = skyline[i].width;
+			}
+		}
+		if (best < 0) return false;
+
+		position = Ivec2(skyline[best].x, best_y);
+		skyline.insert(skyline.begin() + best, { position[0], best_y + h, w });
+
+		// Shrink or remove the nodes now covered by the new one
+		for (std::size_t i = best + 1; i < skyline.size(); i++) {
+			Node& prev = skyline[i - 1];
+			Node& node = skyline[i];
+			int overlap = prev.x + prev.width - node.x;
+			if (overlap <= 0) break;
+			node.x += overlap;
+			node.width -= overlap;
+			if (node.width > 0) break;
+			skyline.erase(skyline.begin() + i--);
+		}
+
+		// Merge neighbours of equal height
+		for (std::size_t i = 0; i + 1 < skyline.size();) {
+			if (skyline[i].y == skyline[i + 1].y) {
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			}
+			else i++;
+		}
+		return true;
+	}
+
+	// Double the smaller dimension of the page, returns false if it reached the maximum size
+	bool Grow(Ivec2 max_size)
+	{
+		Ivec2 next = size;
+		int axis = size[0] <= size[1] ? 0 : 1;
+		if (size[axis] * 2 > max_size[axis]) axis = 1 - axis;
+		if (size[axis] * 2 > max_size[axis]) return false;
+		next[axis] *= 2;
+
+		std::vector<std::uint8_t> grown(std::size_t(next[0]) * next[1] * 4, 0);
+		for (int y = 0; y < size[1]; y++)
+			std::copy_n(pixels.data() + std::size_t(y) * size[0] * 4, size[0] * 4, grown.data() + std::size_t(y) * next[0] * 4);
+		pixels = std::move(grown);
+
+		if (axis == 0) skyline.push_back({ size[0], 0, next[0] - size[0] });
+		size = next;
+		texture->Resize(size);
+		texture->Update(pixels.data(), Ivec2(0), size, 4);
+
+		for (std::size_t i = 0; i < entries.size(); i++)
+			SetUV(*entries[i], rects[i]);
+		return true;
+	}
+
+	void SetUV(SubTexture& entry, Ivec4 const& rect) const
+	{
+		entry.uv_min = Fvec2(float(rect[0]) / size[0], float(rect[1]) / size[1]);
+		entry.uv_max = Fvec2(float(rect[0] + rect[2]) / size[0], float(rect[1] + rect[3]) / size[1]);
+	}
+};
+
+static void expand_to_rgba(std::uint8_t const* src, int channels, std::uint8_t* dst)
+{
+	switch (channels)
+	{
+		case 1: dst[0] = dst[1] = dst[2] = src[0]; dst[3] = 255; break;
+		case 2: dst[0] = dst[1] = dst[2] = src[0]; dst[3] = src[1]; break;
+		case 3: dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 255; break;
+		default: dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = src[3]; break;
+	}
+}
+
+Fvec4 SubTexture::GetRect() const
+{
+	return Fvec4(uv_min[0], uv_min[1], uv_max[0], uv_max[1]);
+}
+
+TextureAtlas::TextureAtlas(Ivec2 max_page_size, int padding)
+	: max_page_size(max_page_size), padding(padding)
+{
+}
+
+TextureAtlas::~TextureAtlas() = default;
+
+SubTexture const* TextureAtlas::Add(std::uint8_t const* data, Ivec2 size, int channels)
+{
+	int w = size[0] + padding * 2, h = size[1] + padding * 2;
+	if (w > max_page_size[0] || h > max_page_size[1]) {
+#if MAYA_DEBUG
+		std::cout << "Image of size " << size[0] << "x" << size[1] << " does not fit into a texture atlas page\n";
+#endif
+		return nullptr;
+	}
+
+	Page* page = nullptr;
+	Ivec2 position;
+	for (auto& p : pages) {
+		bool fit;
+		while (!(fit = p->Insert(w, h, position)) && p->Grow(max_page_size));
+		if (fit) { page = p.get(); break; }
+	}
+
+	if (!page) {
+		Ivec2 initial = atlas_initial_page_size;
+		for (int i = 0; i < 2; i++) {
+			while (initial[i] < (i ? h : w)) initial[i] *= 2;
+			initial[i] = std::min(initial[i], max_page_size[i]);
+		}
+		pages.emplace_back(std::make_unique<Page>(initial));
+		page = pages.back().get();
+		page->Insert(w, h, position);
+	}
+
+	Ivec2 offset = position + Ivec2(padding);
+	std::vector<std::uint8_t> rgba(std::size_t(size[0]) * size[1] * 4);
+	for (int y = 0; y < size[1]; y++) {
+		for (int x = 0; x < size[0]; x++) {
+			std::size_t i = std::size_t(y) * size[0] + x;
+			expand_to_rgba(data + i * channels, channels, rgba.data() + i * 4);
+		}
+		std::copy_n(rgba.data() + std::size_t(y) * size[0] * 4, size[0] * 4,
+			page->pixels.data() + (std::size_t(offset[1] + y) * page->size[0] + offset[0]) * 4);
+	}
+	page->texture->Update(rgba.data(), offset, size, 4);
+	page->used_area += std::int64_t(w) * h;
+
+	Ivec4 rect = Ivec4(offset[0], offset[1], size[0], size[1]);
+	auto entry = std::make_unique<SubTexture>();
+	entry->page = page->texture;
+	entry->size = size;
+	page->SetUV(*entry, rect);
+	page->rects.push_back(rect);
+	page->entries.push_back(std::move(entry));
+	return page->entries.back().get();
+}
+
+SubTexture const* TextureAtlas::Add(std::string const& path)
+{
+	stbi_set_flip_vertically_on_load(true);
+	Ivec2 size;
+	int ch;
+	stbi_uc* data = stbi_load(path.c_str(), &size[0], &size[1], &ch, 4);
+	if (!data) {
+#if MAYA_DEBUG
+		std::cout << "Failed to load image \"" << path << "\" into texture atlas\n";
+#endif
+		return nullptr;
+	}
+	SubTexture const* entry = Add(data, size, 4);
+	stbi_image_free(data);
+	return entry;
+}
+
+int TextureAtlas::GetPageCount() const
+{
+	return int(pages.size());
+}
+
+Texture* TextureAtlas::GetPage(int index) const
+{
+	return pages[index]->texture;
+}
+
+float TextureAtlas::GetPageOccupancy(int index) const
+{
+	Page const& page = *pages[index];
+	return float(page.used_area) / (float(page.size[0]) * page.size[1]);
+}
+
+}
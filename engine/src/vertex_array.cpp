@@ -16,8 +16,6 @@ static struct VAO_OpenGLResourceReleaser {
 	}
 } releaser;
 
-static VertexArray* current_vao = nullptr;
-
 VertexArray::VertexArray(VertexDataStruct& vds, int count, Primitives primitive)
 	: VertexArray(vds, count, primitive, nullptr, 0)
 {
@@ -29,16 +27,25 @@ VertexArray::VertexArray(VertexDataStruct& vds, int count, Primitives primitive,
 	glGenVertexArrays(1, &vaoid);
 	releaser.vaoids.push_back(vaoid);
 	vboids.reserve(2);
+	vbostrides.reserve(2);
+	vbocounts.reserve(2);
+	vbooffsets.reserve(2);
 
 	for (auto& [data, layout] : vds)
 	{
 		auto& vboid = vboids.emplace_back();
-		releaser.bufferids.push_back(vaoid);
+		int elements = layout.count ? layout.count : vertex_count;
+		vbostrides.push_back(layout.stride);
+		vbocounts.push_back(elements);
+		vbooffsets.push_back(0);
+		if (layout.location >= 0) attribloc = layout.location;
 
 		Bind();
 		glGenBuffers(1, &vboid);
+		releaser.bufferids.push_back(vboid);
 		glBindBuffer(GL_ARRAY_BUFFER, vboid);
-		glBufferData(GL_ARRAY_BUFFER, layout.stride * vertex_count * sizeof(float), data, GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, layout.stride * elements * sizeof(float), data,
+			data ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
 
 		for (auto i = 0u; i < layout.attributes.size(); i++)
 		{
@@ -46,6 +53,7 @@ VertexArray::VertexArray(VertexDataStruct& vds, int count, Primitives primitive,
 			auto const& attrib = layout.attributes[i];
 			glVertexAttribPointer(attribloc + i, attrib.count, GL_FLOAT, false,
 				layout.stride * sizeof(float), (void*)(attrib.offset * sizeof(float)));
+			if (layout.divisor) glVertexAttribDivisor(attribloc + i, layout.divisor);
 		}
 
 		attribloc += layout.attributes.size();
@@ -54,6 +62,7 @@ VertexArray::VertexArray(VertexDataStruct& vds, int count, Primitives primitive,
 	}
 
 	if (!ibo) return;
+	Bind();
 	glGenBuffers(1, &iboid);
 	releaser.bufferids.push_back(iboid);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboid);
@@ -65,15 +74,12 @@ VertexArray::VertexArray(VertexDataStruct& vds, int count, Primitives primitive,
 
 void VertexArray::Bind()
 {
-	if (this == current_vao) return;
-	current_vao = this;
-	glBindVertexArray(vaoid);
+	PrivateControl::Instance().gl.BindVertexArray(vaoid);
 }
 
 void VertexArray::Unbind()
 {
-	current_vao = nullptr;
-	glBindVertexArray(0);
+	PrivateControl::Instance().gl.BindVertexArray(0);
 }
 
 void VertexArray::Draw()
@@ -83,4 +89,80 @@ void VertexArray::Draw()
 	else glDrawArrays((unsigned)primitives, 0, vertex_count);
 }
 
+void VertexArray::Draw(int first, int count)
+{
+	Bind();
+	glDrawArrays((unsigned)primitives, first, count);
+}
+
+void VertexArray::DrawInstanced(int instances)
+{
+	Bind();
+	if (iboid) glDrawElementsInstanced((unsigned)primitives, elem_to_draw, GL_UNSIGNED_INT, 0, instances);
+	else glDrawArraysInstanced((unsigned)primitives, 0, vertex_count, instances);
+}
+
+void VertexArray::DrawElements(int first, int count)
+{
+	Bind();
+	glDrawElements((unsigned)primitives, count, GL_UNSIGNED_INT, (void*)(first * sizeof(unsigned int)));
+}
+
+void VertexArray::DrawElementsInstanced(int first, int count, int instances)
+{
+	Bind();
+	glDrawElementsInstanced((unsigned)primitives, count, GL_UNSIGNED_INT, (void*)(first * sizeof(unsigned int)), instances);
+}
+
+void VertexArray::Release()
+{
+	if (!vaoid) return;
+	Unbind();
+	std::erase(releaser.vaoids, vaoid);
+	glDeleteVertexArrays(1, &vaoid);
+	if (iboid) vboids.push_back(iboid);
+	for (auto id : vboids) {
+		std::erase(releaser.bufferids, id);
+		glDeleteBuffers(1, &id);
+	}
+	vaoid = iboid = 0;
+	vboids.clear();
+}
+
+void VertexArray::UpdateVBO(int index, float const* data, int count)
+{
+	// attribute pointers refer to the buffer object, so its storage could be reallocated freely
+	int size = vbostrides[index] * sizeof(float);
+	glBindBuffer(GL_ARRAY_BUFFER, vboids[index]);
+	if (count > vbocounts[index]) {
+		vbocounts[index] = std::max(count, vbocounts[index] * 2);
+		glBufferData(GL_ARRAY_BUFFER, size * vbocounts[index], nullptr, GL_DYNAMIC_DRAW);
+	}
+	glBufferSubData(GL_ARRAY_BUFFER, 0, size * count, data);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	vbooffsets[index] = count;
+}
+
+int VertexArray::StreamVBO(int index, float const* data, int count)
+{
+	int size = vbostrides[index] * sizeof(float);
+	glBindBuffer(GL_ARRAY_BUFFER, vboids[index]);
+	if (vbooffsets[index] + count > vbocounts[index]) {
+		vbocounts[index] = std::max(count, vbocounts[index]);
+		glBufferData(GL_ARRAY_BUFFER, size * vbocounts[index], nullptr, GL_DYNAMIC_DRAW);
+		vbooffsets[index] = 0;
+	}
+
+	int first = vbooffsets[index];
+	void* out = glMapBufferRange(GL_ARRAY_BUFFER, first * size, count * size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (out) {
+		std::memcpy(out, data, count * size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	vbooffsets[index] = first + count;
+	return first;
+}
+
 }
\ No newline at end of file
@@ -41,4 +41,21 @@ std::string GetWindowTitle()
 	return ctrl.windata.title;
 }
 
+void SetRedrawMode(RedrawMode mode)
+{
+	auto& ctrl = PrivateControl::Instance();
+	ctrl.redraw_mode = mode;
+	ctrl.damage.InvalidateAll();
+}
+
+void InvalidateRegion(Ivec4 rect)
+{
+	PrivateControl::Instance().damage.Invalidate(rect);
+}
+
+void InvalidateWindow()
+{
+	PrivateControl::Instance().damage.InvalidateAll();
+}
+
 }
\ No newline at end of file
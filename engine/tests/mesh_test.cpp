@@ -0,0 +1,81 @@
+// Loads OBJ files through Mesh::Load, no window or OpenGL context is needed
+#include <Maya.hpp>
+#include <Maya3D.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using namespace Maya;
+
+static int failures = 0;
+
+static void check(bool condition, char const* what)
+{
+	if (condition) return;
+	std::cout << "FAILED: " << what << "\n";
+	failures++;
+}
+
+static std::string write_file(std::string const& name, std::string const& content)
+{
+	std::string path = (std::filesystem::temp_directory_path() / name).string();
+	std::ofstream(path, std::ios::binary) << content;
+	return path;
+}
+
+// Position of the vertex behind an index
+static Fvec3 corner(MeshData const& data, std::size_t i)
+{
+	float const* v = &data.vertices[std::size_t(data.indices[i]) * 8];
+	return Fvec3(v[0], v[1], v[2]);
+}
+
+// A relative face in a later chunk than the vertices it refers to
+static void relative_indices_across_chunks()
+{
+	std::string obj;
+	int vertices = 0;
+	while (obj.size() < (1 << 20) + 4096) {
+		obj += "v " + std::to_string(vertices) + " 1 2\n";
+		vertices++;
+	}
+	// comments push the face past the cut in the middle of the file
+	std::string padding = "# " + std::string(100, '-') + "\n";
+	while (obj.size() < (5 << 19)) obj += padding;
+	obj += "f -1 -2 -3\n";
+	obj += "f 1 2 3\n";
+
+	MeshData data;
+	bool ok = Mesh::Load(write_file("maya_mesh_test_chunks.obj", obj), data, false);
+	check(ok, "OBJ with relative indices across chunks loads");
+	check(data.indices.size() == 6, "two triangles are read");
+	if (!ok || data.indices.size() != 6) return;
+	check(corner(data, 0) == Fvec3(float(vertices - 1), 1.0f, 2.0f), "-1 refers to the last vertex");
+	check(corner(data, 1) == Fvec3(float(vertices - 2), 1.0f, 2.0f), "-2 refers to the second last vertex");
+	check(corner(data, 2) == Fvec3(float(vertices - 3), 1.0f, 2.0f), "-3 refers to the third last vertex");
+	check(corner(data, 3) == Fvec3(0.0f, 1.0f, 2.0f), "absolute indices stay absolute");
+}
+
+// Relative indices within a single chunk, with shared corners merged
+static void relative_indices_in_chunk()
+{
+	std::string obj =
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+		"vt 0 0\nvt 1 1\n"
+		"f 1/1 2/2 3/2 4/1\n"
+		"f -4 -2 -1\n";
+
+	MeshData data;
+	bool ok = Mesh::Load(write_file("maya_mesh_test_quad.obj", obj), data, false);
+	check(ok, "small OBJ loads");
+	check(data.indices.size() == 9, "a quad and a triangle give three triangles");
+	check(data.vertices.size() / 8 == 5, "identical corners are merged");
+}
+
+int main()
+{
+	relative_indices_across_chunks();
+	relative_indices_in_chunk();
+	if (failures == 0) std::cout << "All mesh tests passed\n";
+	return failures == 0 ? 0 : 1;
+}